@@ -58,11 +58,11 @@ extern Protomatter_core *_PM_protoPtr; ///< In core.c (via arch.h)
 // for a single constant, thank you for coming to my TED talk!
 #define _PM_MAX_REFRESH_HZ 250 ///< Upper limit (ish) to matrix refresh rate
 
-// Time (in milliseconds) to pause following any change in address lines
+// Time (in microseconds) to pause following any change in address lines
 // (individually or collectively). Some matrices respond slowly there...
 // must pause on change for matrix to catch up. Defined here (rather than
 // arch.h) because it's not architecture-specific.
-#define _PM_ROW_DELAY 8 ///< Delay time between row address line changes (ms)
+#define _PM_ROW_DELAY 8 ///< Delay time between row address line changes (us)
 
 Adafruit_Protomatter::Adafruit_Protomatter(uint16_t bitWidth, uint8_t bitDepth,
                                            uint8_t rgbCount, uint8_t *rgbList,
@@ -102,6 +102,146 @@ void Adafruit_Protomatter::show(void) {
   _PM_swapbuffer_maybe(&core);
 }
 
+// As above, but only for a region of the canvas. Rest of the matrix
+// framebuffer is left as-is (brought up to date first if double-buffered).
+void Adafruit_Protomatter::show(int16_t x, int16_t y, int16_t w, int16_t h) {
+  _PM_convert_565_rect(&core, getBuffer(), WIDTH, x, y, w, h);
+  _PM_swapbuffer_maybe(&core);
+}
+
+// Progressive update, see _PM_convert_565_coarse() in core.h. Coarse frame
+// is swapped in immediately, then each refined one.
+void Adafruit_Protomatter::showCoarse(uint8_t planes) {
+  _PM_convert_565_coarse(&core, getBuffer(), WIDTH, planes);
+  _PM_swapbuffer_maybe(&core);
+}
+
+bool Adafruit_Protomatter::refine(uint8_t planes) {
+  if (!core.refinePlanes)
+    return false; // Nothing converted, nothing to swap
+  uint8_t left = _PM_convert_565_refine(&core, getBuffer(), WIDTH, planes);
+  _PM_swapbuffer_maybe(&core);
+  return left > 0;
+}
+
+// Canvas regions drawn by separate producers, see _PM_regionAdd() in
+// core.h.
+int8_t Adafruit_Protomatter::addRegion(int16_t x, int16_t y, int16_t w,
+                                       int16_t h) {
+  return _PM_regionAdd(&core, x, y, w, h);
+}
+
+void Adafruit_Protomatter::commitRegion(uint8_t region) {
+  _PM_regionCommit(&core, region);
+}
+
+bool Adafruit_Protomatter::regionPending(uint8_t region) {
+  return _PM_regionPending(&core, region);
+}
+
+uint8_t Adafruit_Protomatter::showRegions(void) {
+  return _PM_regionShow(&core, getBuffer(), WIDTH);
+}
+
+// Set pixels in canvas and matrix framebuffer without a full conversion,
+// see _PM_convert_565_xor() in core.h. Deltas are worked out from the
+// canvas in small batches, so the caller's list can be any length.
+void Adafruit_Protomatter::showPixels(const _PM_pixel *pixels,
+                                      uint16_t count) {
+  uint16_t *buf = getBuffer();
+  int16_t mw = WIDTH >> core.doubleColumns, mh = HEIGHT >> core.doubleRows;
+  _PM_pixel batch[32];
+  uint8_t n = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    int16_t x = pixels[i].x, y = pixels[i].y;
+    if ((x < 0) || (y < 0) || (x >= mw) || (y >= mh))
+      continue;
+    uint16_t *p = &buf[y * WIDTH + x];
+    batch[n].x = x;
+    batch[n].y = y;
+    batch[n].color = *p ^ pixels[i].color; // Old XOR new
+    *p = pixels[i].color;
+    if (++n == sizeof batch / sizeof batch[0]) {
+      _PM_convert_565_xor(&core, batch, n);
+      n = 0;
+    }
+  }
+  _PM_convert_565_xor(&core, batch, n);
+  _PM_swapbuffer_maybe(&core);
+}
+
+// Indexed-color images direct to the matrix framebuffer (canvas is not
+// used), see _PM_paletteBegin() in core.c.
+ProtomatterStatus Adafruit_Protomatter::paletteBegin(const uint16_t *palette,
+                                                     uint16_t count) {
+  return _PM_paletteBegin(&core, palette, count);
+}
+
+void Adafruit_Protomatter::paletteLine(int16_t x, int16_t y,
+                                       const uint8_t *indices, uint16_t w) {
+  _PM_paletteLine(&core, x, y, indices, w);
+}
+
+void Adafruit_Protomatter::paletteEnd(void) {
+  _PM_paletteEnd(&core);
+  _PM_swapbuffer_maybe(&core);
+}
+
+// Pre-encoded matrix data direct to the framebuffer, see _PM_loadPayload()
+// in core.c.
+uint32_t Adafruit_Protomatter::payloadSize(void) {
+  return _PM_payloadSize(&core);
+}
+
+ProtomatterStatus Adafruit_Protomatter::loadPayload(const void *data,
+                                                    uint32_t offset,
+                                                    uint32_t length) {
+  return _PM_loadPayload(&core, data, offset, length);
+}
+
+void Adafruit_Protomatter::showPayload(void) { _PM_swapbuffer_maybe(&core); }
+
+// Shift a region of the canvas and matrix framebuffer alike, so they stay
+// in sync and only the newly-exposed strip needs drawing & converting.
+void Adafruit_Protomatter::scroll(int16_t x, int16_t y, int16_t w, int16_t h,
+                                  int16_t dx, int16_t dy) {
+  // Clip to matrix bounds (core function clips the same way). With pixel
+  // doubling that's less than the canvas; WIDTH is still the row stride.
+  int16_t mw = WIDTH >> core.doubleColumns, mh = HEIGHT >> core.doubleRows;
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > mw)
+    w = mw - x;
+  if (y + h > mh)
+    h = mh - y;
+  if ((w <= 0) || (h <= 0))
+    return;
+
+  // Canvas pixels move the same direction, working from the far side
+  // so nothing's overwritten before it's copied.
+  uint16_t *buf = getBuffer();
+  for (int16_t j = 0; j < h; j++) {
+    int16_t yd = (dy > 0) ? (y + h - 1 - j) : (y + j);
+    int16_t ys = yd - dy;
+    for (int16_t i = 0; i < w; i++) {
+      int16_t xd = (dx > 0) ? (x + w - 1 - i) : (x + i);
+      int16_t xs = xd - dx;
+      buf[yd * WIDTH + xd] =
+          ((ys >= y) && (ys < y + h) && (xs >= x) && (xs < x + w))
+              ? buf[ys * WIDTH + xs]
+              : 0;
+    }
+  }
+
+  _PM_scroll(&core, x, y, w, h, dx, dy);
+}
+
 // Returns current value of frame counter and resets its value to zero.
 // Two calls to this, timed one second apart (or use math with other
 // intervals), can be used to get a rough frames-per-second value for
@@ -109,3 +249,93 @@ void Adafruit_Protomatter::show(void) {
 uint32_t Adafruit_Protomatter::getFrameCount(void) {
   return _PM_getFrameCount(_PM_protoPtr);
 }
+
+// Wait for end of current frame, see _PM_waitVblank() in core.c.
+void Adafruit_Protomatter::waitVblank(void) { _PM_waitVblank(&core); }
+
+// Frame pacing for double-buffered animation, see _PM_setFrameRate() in
+// core.c.
+uint8_t Adafruit_Protomatter::setFrameRate(uint16_t fps) {
+  return _PM_setFrameRate(&core, fps);
+}
+
+void Adafruit_Protomatter::getFrameStats(uint32_t *dropped,
+                                         uint32_t *duplicated) {
+  _PM_getFrameStats(&core, dropped, duplicated);
+}
+
+// Measured bitplane timing, see _PM_getPlaneTiming() in core.c.
+uint8_t Adafruit_Protomatter::getPlaneTiming(_PM_planeTiming *timing) {
+  return _PM_getPlaneTiming(&core, timing);
+}
+
+// Row handler cost for benchmarking, see _PM_getRowCost() in core.c.
+bool Adafruit_Protomatter::getRowCost(_PM_rowCost *cost) {
+  return _PM_getRowCost(&core, cost);
+}
+
+// Briefly suspend matrix refresh so the RGB data and clock pins can be
+// used by another peripheral (e.g. SPI flash or SD card), then carry on
+// where it left off. See _PM_pause() in core.c for details.
+void Adafruit_Protomatter::pause(void) { _PM_pause(&core); }
+
+void Adafruit_Protomatter::resume(void) { _PM_unpause(&core); }
+
+// Use OUT-register writes for RGB data on devices without toggle
+// register, see _PM_setDirectOut() in core.c.
+bool Adafruit_Protomatter::setDirectOut(bool enable) {
+  return _PM_setDirectOut(&core, enable);
+}
+
+// Use 32-bit matrix data storage regardless of pin layout, see
+// _PM_setLongElements() in core.c. Call before begin().
+void Adafruit_Protomatter::setLongElements(bool enable) {
+  _PM_setLongElements(&core, enable);
+}
+
+// Show each pixel as 2 columns and/or rows of LEDs, see
+// _PM_setPixelDoubling() in core.c. Canvas buffer stays full size (it's
+// allocated in the constructor), only the drawable area shrinks; show()
+// still passes the full canvas width as the row stride.
+bool Adafruit_Protomatter::setPixelDoubling(bool columns, bool rows) {
+  if (!_PM_setPixelDoubling(&core, columns, rows))
+    return false;
+  _width = WIDTH >> columns;
+  _height = HEIGHT >> rows;
+  return true;
+}
+
+// Split data shifting out of the timer interrupt, see
+// _PM_setDeferredShift() in core.c.
+void Adafruit_Protomatter::setDeferredShift(void (*signal)(void)) {
+  _PM_setDeferredShift(&core, signal);
+}
+
+void Adafruit_Protomatter::rowShift(void) { _PM_row_shift(&core); }
+
+// Handle very short planes within one interrupt, see _PM_setCoalescing()
+// in core.c.
+void Adafruit_Protomatter::setCoalescing(bool enable) {
+  _PM_setCoalescing(&core, enable);
+}
+
+// Skip unchanged rows in show(), see _PM_setRowHashing() in core.c.
+void Adafruit_Protomatter::setRowHashing(bool enable) {
+  _PM_setRowHashing(&core, enable);
+}
+
+uint32_t Adafruit_Protomatter::getLateShifts(void) {
+  return _PM_getLateShifts(&core);
+}
+
+// Panel-specific timing (address settle time, etc.), see
+// _PM_setPanelProfile() in core.c. Can be called at any time.
+void Adafruit_Protomatter::setPanelProfile(const _PM_panelProfile &profile) {
+  _PM_setPanelProfile(&core, &profile);
+}
+
+// Set relative bitplane display times, see _PM_setPlaneWeights() in core.c.
+ProtomatterStatus
+Adafruit_Protomatter::setPlaneWeights(const uint16_t *weights) {
+  return _PM_setPlaneWeights(&core, weights);
+}
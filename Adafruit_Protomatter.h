@@ -79,12 +79,190 @@ public:
   */
   ProtomatterStatus begin(void);
 
+  /*!
+    @brief  Store matrix data as 32-bit values regardless of RGB pin
+            layout, for the fastest possible data output on devices
+            with 32-bit-only GPIO access (e.g. Teensy 4.x). Uses 2 to 4
+            times the matrix RAM. Must be called BEFORE begin().
+    @param  enable  true for 32-bit storage, false (default) for the
+                    most compact storage allowed by the pin layout.
+  */
+  void setLongElements(bool enable);
+
+  /*!
+    @brief  Show each pixel as a 2x1, 1x2 or 2x2 block of LEDs, for low-
+            resolution content on a larger matrix (e.g. 32x16 graphics on
+            a 64x32 panel) using 1/2 or 1/4 the matrix RAM and conversion
+            time. Drawing coordinates then cover the smaller size. Must be
+            called BEFORE begin(), and isn't compatible with setRotation().
+    @param  columns  true to double each column.
+    @param  rows     true to double each row.
+    @return true on success, false if called after begin() or the matrix
+            size doesn't allow it.
+  */
+  bool setPixelDoubling(bool columns, bool rows);
+
   /*!
     @brief Process data from GFXcanvas16 to the matrix framebuffer's
            internal format for display.
   */
   void show(void);
 
+  /*!
+    @brief Process only a rectangular region of the GFXcanvas16 to the
+           matrix framebuffer, for when just part of the image has changed
+           (e.g. the strip exposed by scroll()). Much faster than a full
+           show() for small regions.
+    @param x  Left edge of region, in pixels.
+    @param y  Top edge of region, in pixels.
+    @param w  Width of region, in pixels.
+    @param h  Height of region, in pixels.
+  */
+  void show(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  /*!
+    @brief  Show a quick approximation of the canvas, converting only the
+            top few bitplanes, for lower latency with fast-moving content.
+            Follow with refine() calls to fill in the remaining detail.
+    @param  planes  Number of most significant bitplanes to convert now.
+  */
+  void showCoarse(uint8_t planes = 3);
+
+  /*!
+    @brief  Fill in lower bitplanes following showCoarse(), a few at a
+            time, e.g. once per loop() while there's nothing new to draw.
+            If double-buffered, each call swaps in the refined frame
+            (waiting for the end of a refresh, like show()). Don't draw
+            to the canvas until it returns false (or call show() or
+            showCoarse() again to start over).
+    @param  planes  Number of bitplanes to convert in this call.
+    @return true if more planes remain, false once the image is complete.
+  */
+  bool refine(uint8_t planes = 1);
+
+  /*!
+    @brief  Define a region of the canvas that's drawn and committed on
+            its own, e.g. by a separate task. Up to _PM_MAX_REGIONS.
+    @param  x  Left edge, in pixels.
+    @param  y  Top edge, in pixels.
+    @param  w  Width, in pixels.
+    @param  h  Height, in pixels.
+    @return Region index for commitRegion(), or -1 if none left.
+  */
+  int8_t addRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  /*!
+    @brief  Mark a region as drawn and ready to show. Can be called from
+            another task or core without locking, but only from one per
+            region. Don't draw in the region again until regionPending()
+            returns false.
+    @param  region  Index returned by addRegion().
+  */
+  void commitRegion(uint8_t region);
+
+  /*!
+    @brief  Check whether a region's last commit hasn't been shown yet.
+    @param  region  Index returned by addRegion().
+    @return true until showRegions() has converted and swapped it in.
+  */
+  bool regionPending(uint8_t region);
+
+  /*!
+    @brief  Convert all committed regions and show them together with a
+            single buffer swap. Call from one task only, e.g. loop().
+    @return Number of regions updated (0 = nothing committed, no swap).
+  */
+  uint8_t showRegions(void);
+
+  /*!
+    @brief  Set a batch of individual pixels in both the canvas and matrix
+            framebuffer, then show the result. Much faster than a full
+            show() when only a few pixels change per frame (e.g. moving
+            sand grains), as work is proportional to pixels changed, not
+            panel size. The canvas must otherwise be in sync with the
+            matrix (i.e. no other drawing since the last show()).
+    @param  pixels  Array of _PM_pixel structs, x & y & new 565 color
+                    (color is a new color here, NOT a delta; this
+                    function works out deltas from the canvas).
+    @param  count   Number of elements in pixels array.
+  */
+  void showPixels(const _PM_pixel *pixels, uint16_t count);
+
+  /*!
+    @brief  Start writing an indexed-color image (e.g. a decoded GIF
+            frame) straight to the matrix framebuffer, bypassing the
+            canvas. The palette is pre-expanded once here; follow with
+            any number of paletteLine() calls and then paletteEnd().
+            The canvas is NOT updated, so don't mix with show() in the
+            same frame.
+    @param  palette  Array of 565 colors.
+    @param  count    Number of palette entries (max 256).
+    @return A ProtomatterStatus status type, same as begin().
+  */
+  ProtomatterStatus paletteBegin(const uint16_t *palette, uint16_t count);
+
+  /*!
+    @brief  Write a line (or partial line) of palette indices to the matrix
+            framebuffer, between paletteBegin() and paletteEnd(). Suitable
+            as (or called from) a GIF decoder's per-line draw callback.
+    @param  x        Left edge of line, in pixels.
+    @param  y        Row, in pixels.
+    @param  indices  Array of palette indices, one per pixel. Indices past
+                     the end of the palette are left as-is (transparent).
+    @param  w        Number of pixels.
+  */
+  void paletteLine(int16_t x, int16_t y, const uint8_t *indices, uint16_t w);
+
+  /*!
+    @brief  Finish an indexed-color image started with paletteBegin() and
+            show it.
+  */
+  void paletteEnd(void);
+
+  /*!
+    @brief  Get size, in bytes, of pre-encoded matrix data for
+            loadPayload() (one full matrix buffer).
+    @return Payload size in bytes, or 0 if begin() has not been called.
+  */
+  uint32_t payloadSize(void);
+
+  /*!
+    @brief  Copy pre-encoded matrix data (e.g. from a video wall
+            controller) straight to the matrix framebuffer, bypassing the
+            canvas and conversion. Can be called with successive chunks
+            as data arrives, then showPayload() to display it.
+    @param  data    Pointer to payload data.
+    @param  offset  Byte offset of data within payload.
+    @param  length  Number of bytes.
+    @return A ProtomatterStatus status type, same as begin().
+  */
+  ProtomatterStatus loadPayload(const void *data, uint32_t offset,
+                                uint32_t length);
+
+  /*!
+    @brief  Display data loaded with loadPayload() (swaps buffers if
+            double-buffered, else it's already showing).
+  */
+  void showPayload(void);
+
+  /*!
+    @brief  Shift a rectangular region of the image by some number of
+            pixels, in both the canvas and the matrix framebuffer (without
+            reconverting the whole thing). Pixels shifted in from outside
+            the region are cleared to 0; draw whatever belongs there, then
+            call show(x, y, w, h) for just that strip. With double
+            buffering, the scrolled image appears on that show() call;
+            otherwise it's visible immediately.
+    @param  x   Left edge of region, in pixels.
+    @param  y   Top edge of region, in pixels.
+    @param  w   Width of region, in pixels.
+    @param  h   Height of region, in pixels.
+    @param  dx  Horizontal shift in pixels, positive = right.
+    @param  dy  Vertical shift in pixels, positive = down.
+  */
+  void scroll(int16_t x, int16_t y, int16_t w, int16_t h, int16_t dx,
+              int16_t dy);
+
   /*!
     @brief  Returns current value of frame counter and resets its value
             to zero. Two calls to this, timed one second apart (or use
@@ -95,6 +273,145 @@ public:
   */
   uint32_t getFrameCount(void);
 
+  /*!
+    @brief  Wait until the current frame has been fully shown on the
+            matrix, e.g. to sync animation to the refresh rate. On ESP32
+            this blocks the calling task (other tasks, such as WiFi, keep
+            running) rather than spinning.
+  */
+  void waitVblank(void);
+
+  /*!
+    @brief  Pace show() calls on a double-buffered matrix so each frame
+            is displayed for the same number of matrix refreshes, for
+            smooth animation without a delay() loop. show() then waits
+            as needed to keep that rate. The refreshes per frame are
+            re-measured as the refresh rate settles, so this can be
+            called right after begin().
+    @param  fps  Target frames per second, or 0 to disable pacing.
+    @return Initial estimate of matrix refreshes per frame (0 if pacing
+            is off or the matrix is not double-buffered).
+  */
+  uint8_t setFrameRate(uint16_t fps);
+
+  /*!
+    @brief  Get and reset frame pacing statistics (see setFrameRate()).
+    @param  dropped     Receives number of frames that missed their slot
+                        since the previous call (or NULL).
+    @param  duplicated  Receives number of extra refreshes of late frames
+                        since the previous call (or NULL).
+  */
+  void getFrameStats(uint32_t *dropped, uint32_t *duplicated);
+
+  /*!
+    @brief  Get measured versus requested display time of each bitplane,
+            and the ratio between successive planes (ideally 2:1), to see
+            how ISR latency and timer limits skew color rendering while
+            tuning bit depth, chain length, etc.
+    @param  timing  Array of _PM_planeTiming structs, one per bitplane.
+    @return Number of elements filled in (bit depth, or 0 if not started).
+  */
+  uint8_t getPlaneTiming(_PM_planeTiming *timing);
+
+  /*!
+    @brief  Get the row handler's cost on this device: PORT writes per
+            column and interrupt entry and data shift times, for
+            benchmarking. See _PM_getRowCost() in core.h.
+    @param  cost  _PM_rowCost struct to be filled in.
+    @return true on success, false if called before begin().
+  */
+  bool getRowCost(_PM_rowCost *cost);
+
+  /*!
+    @brief  Briefly suspend matrix refresh, e.g. so the RGB data and clock
+            pins can be shared with an SPI flash chip or SD card. Output
+            is blanked for the duration; this is much faster than a full
+            stop/restart and the display resumes mid-frame. Address,
+            latch and OE pins must not be shared.
+  */
+  void pause(void);
+
+  /*!
+    @brief  Continue matrix refresh following a call to pause(). RGB data
+            and clock pins are made outputs again automatically, but if
+            the other bus switched them to a peripheral function (as some
+            SPI libraries do), call pinMode() on them first.
+  */
+  void resume(void);
+
+  /*!
+    @brief  Shift matrix data outside the timer interrupt, so it stays
+            short. See _PM_setDeferredShift() in core.h.
+    @param  signal  Function called from the timer interrupt when data is
+                    ready to shift, typically pending a lower-priority
+                    interrupt whose handler calls rowShift(). NULL for the
+                    default (shift in the timer interrupt).
+  */
+  void setDeferredShift(void (*signal)(void));
+
+  /*!
+    @brief  Shift out pending matrix data, when setDeferredShift() is in
+            use. Must run after each timer interrupt, before the next.
+  */
+  void rowShift(void);
+
+  /*!
+    @brief  Enable or disable interrupt coalescing (off by default): very
+            short bitplanes are handled within one timer interrupt rather
+            than one interrupt each. See _PM_setCoalescing() in core.h.
+    @param  enable  true to enable, false to disable.
+  */
+  void setCoalescing(bool enable);
+
+  /*!
+    @brief  Enable or disable skipping unchanged rows in show() (on by
+            default). Off, every show() converts the whole canvas. See
+            _PM_setRowHashing() in core.h.
+    @param  enable  true to enable, false to disable.
+  */
+  void setRowHashing(bool enable);
+
+  /*!
+    @brief  Check whether deferred shifts are keeping up.
+    @return Number of times data wasn't shifted in time since the last
+            call (each stretches a bitplane, lowering refresh rate).
+  */
+  uint32_t getLateShifts(void);
+
+  /*!
+    @brief  Set panel timing: address settle time after each row change
+            and the guard time before output is enabled. Default suits
+            the slowest panels; _PM_panelFast skips the settle time, or
+            pass a custom _PM_panelProfile. Can be called at any time.
+    @param  profile  Timing profile, values are copied.
+  */
+  void setPanelProfile(const _PM_panelProfile &profile);
+
+  /*!
+    @brief  Set relative display time of each bitplane (default is binary,
+            each plane twice as long as the one before). Call after
+            begin().
+    @param  weights  Array of weights, one per bitplane, least significant
+                     first. Scaled relative to weights[0], e.g. {1, 2, 4,
+                     8} is the default for 4 planes.
+    @return PROTOMATTER_OK on success, PROTOMATTER_ERR_ARG if called
+            before begin() or weights[0] is zero.
+  */
+  ProtomatterStatus setPlaneWeights(const uint16_t *weights);
+
+  /*!
+    @brief  On devices without a GPIO toggle register (e.g. nRF52), write
+            RGB data and clock straight to the PORT OUT register, two
+            writes per column instead of three, for a faster refresh.
+            Off by default. Only safe if no other pins on the RGB data
+            PORT are changed from a higher-priority interrupt or by DMA.
+            Suspended while setDeferredShift() is in use.
+    @param  enable  true to enable, false to disable.
+    @return true if direct writes are now in use, false if disabled,
+            suspended or not supported on this device.
+  */
+  bool setDirectOut(bool enable);
+
 private:
   Protomatter_core core;             // Underlying C struct
   void convert_byte(uint8_t *dest);  // GFXcanvas16-to-matrix
@@ -61,6 +61,10 @@ _PM_portClearRegister(pin):  Get address of PORT clear-bits register.
 _PM_portToggleRegister(pin): Get address of PORT toggle-bits register.
                              Not all devices support this, in which case
                              it must be left undefined.
+_PM_portDirSetRegister(pin): Get address of PORT direction-set register
+                             (writing 1 bits makes those pins outputs).
+                             Optional; if undefined, _PM_unpause() falls
+                             back on _PM_pinOutput() for each pin.
 _PM_portBitMask(pin):        Get bit mask within PORT register corresponding
                              to a pin number. When compiling for Arduino,
                              this just maps to digitalPinToBitMask(), other
@@ -87,9 +91,38 @@ _PM_timerInit(void*):        Initialize (but do not start) timer.
 _PM_timerStart(void*,count): (Re)start timer for a given timer-tick interval.
 _PM_timerStop(void*):        Stop timer, return current timer counter value.
 _PM_timerGetCount(void*):    Get current timer counter value (whether timer
-                             is running or stopped).
+                             is running or stopped). On reaching its period
+                             the count may restart from zero (e.g. SAMD MFRQ
+                             mode, auto-reload) or carry on; either is OK.
+_PM_timerMaxCount:           Largest period the timer can count, if less
+                             than 32 bits (e.g. 65535 for a 16-bit timer).
+                             Optional; if defined, _PM_timerMaxShift and
+                             _PM_timerPrescale() are also required, and the
+                             timer is prescaled as needed to fit the longest
+                             bitplane period.
+_PM_timerMaxShift:           Largest prescale supported, as a power of two
+                             (all shifts from 0 to this must be valid).
+_PM_timerPrescale(void*,shift): Set timer to count at _PM_timerFreq >> shift.
+                             Only called while the timer is stopped.
+                             _PM_timerInit() must leave it unprescaled.
 A timer interrupt service routine is also required, syntax for which varies
 between architectures.
+_PM_vblankSignal(core):      Called from the row handler (interrupt context)
+                             each time a full frame has been issued, after
+                             any pending buffer swap. Optional, default is
+                             to do nothing.
+_PM_vblankWait(core):        Block the calling task until the next
+                             _PM_vblankSignal() (or some short timeout).
+                             Callers loop on whatever they're waiting for,
+                             so early or spurious returns are harmless.
+                             Evaluates to true, or false if the row handler
+                             can't run at all (e.g. host emulation with the
+                             timer stopped) so the caller should give up.
+                             Optional, default returns true immediately
+                             (i.e. callers spin). On an RTOS this lets other
+                             tasks run while waiting on a buffer swap, e.g.
+                             with a binary semaphore; a hosted port could
+                             use a pthread condition variable.
 The void* argument passed to the timer functions is some indeterminate type
 used to uniquely identify a timer peripheral within a given environment. For
 example, in the Arduino wrapper for this library, compiling for SAMD chips,
@@ -130,6 +163,18 @@ _PM_clockHoldLow:            Additional code (e.g. NOPs) needed to delay
 _PM_minMinPeriod:            Mininum value for the "minPeriod" class member,
                              so bit-angle-modulation time always doubles with
                              each bitplane (else lower bits may be the same).
+_PM_SET_CLEAR_COMBINED:      Define (no value) if the PORT set and clear
+                             registers are two halves of one 32-bit register
+                             (e.g. STM32 BSRR, set bits in the lower 16, clear
+                             bits in the upper 16). Matrix data is then
+                             always stored as 32-bit elements holding both,
+                             so each column takes two PORT writes instead of
+                             three. Not for use with a toggle register.
+PEW:                         Code to issue one element of RGB data and a
+                             clock pulse, if the default in core.c won't
+                             do (e.g. ESP32). Optional; if defined, also
+                             define _PM_PEW_WRITES, the number of PORT
+                             writes it makes, for _PM_getRowCost().
 */
 
 #if defined(ARDUINO) // If compiling in Arduino IDE...
@@ -160,6 +205,18 @@ _PM_minMinPeriod:            Mininum value for the "minPeriod" class member,
 #define STM32F4_SERIES (1)
 #endif
 
+#elif defined(_PM_HOST)
+// Host (e.g. Linux) simulation for tests and analysis tools, see
+// extras/host. Not a real device; GPIO, timer and matrix are emulated.
+#include "extras/host/host.h"
+
+#define _PM_delayMicroseconds(us) _PM_hostDelay(us)
+#define _PM_pinOutput(pin) _PM_hostPinOutput(pin)
+#define _PM_pinInput(pin) _PM_hostPinInput(pin)
+#define _PM_pinHigh(pin) _PM_hostPinHigh(pin)
+#define _PM_pinLow(pin) _PM_hostPinLow(pin)
+#define _PM_portBitMask(pin) (1u << ((pin) % _PM_HOST_PORT_BITS))
+
 // No #else here. In non-Arduino case, declare things in the arch-specific
 // sections below...unless other environments provide device-neutral
 // functions as above, in which case those could go here (w/#elif).
@@ -271,6 +328,9 @@ void _PM_IRQ_HANDLER(void) {
 #define _PM_portToggleRegister(pin)                                            \
   &PORT->Group[g_APinDescription[pin].ulPort].OUTTGL.reg
 
+#define _PM_portDirSetRegister(pin)                                            \
+  &PORT->Group[g_APinDescription[pin].ulPort].DIRSET.reg
+
 #elif defined(CIRCUITPY)
 
 #include "hal_gpio.h"
@@ -283,6 +343,8 @@ void _PM_IRQ_HANDLER(void) {
 
 #define _PM_portToggleRegister(pin) (&PORT->Group[(pin / 32)].OUTTGL.reg)
 
+#define _PM_portDirSetRegister(pin) (&PORT->Group[(pin / 32)].DIRSET.reg)
+
 #else
 
 // Other port register lookups go here
@@ -430,6 +492,20 @@ uint32_t _PM_timerStop(void *tptr) {
   return count;
 }
 
+// 16-bit timer overflows on the longest bitplane at deep bit depths or low
+// refresh rates, so core.c prescales as needed (DIV1 through DIV16 map
+// directly to shifts 0-4, DIV64+ skip some so aren't used).
+#define _PM_timerMaxCount 65535
+#define _PM_timerMaxShift 4
+
+// Set prescaler, timer must be stopped.
+void _PM_timerPrescale(void *tptr, uint8_t shift) {
+  Tc *tc = (Tc *)tptr; // Cast peripheral address passed in
+  tc->COUNT16.CTRLA.bit.PRESCALER = shift; // DIV1 (0) to DIV16 (4)
+  while (tc->COUNT16.SYNCBUSY.bit.ENABLE)
+    ;
+}
+
 // See notes in core.c before the "blast" functions
 #if F_CPU >= 200000000
 #define _PM_clockHoldHigh asm("nop; nop; nop; nop; nop");
@@ -468,6 +544,9 @@ uint32_t _PM_timerStop(void *tptr) {
 #define _PM_portToggleRegister(pin)                                            \
   &PORT_IOBUS->Group[g_APinDescription[pin].ulPort].OUTTGL.reg
 
+#define _PM_portDirSetRegister(pin)                                            \
+  &PORT_IOBUS->Group[g_APinDescription[pin].ulPort].DIRSET.reg
+
 #else
 
 // Non-Arduino port register lookups go here
@@ -578,6 +657,18 @@ inline uint32_t _PM_timerStop(void *tptr) {
   return count;
 }
 
+// See SAMD51 notes above re: prescaling the 16-bit timer.
+#define _PM_timerMaxCount 65535
+#define _PM_timerMaxShift 4
+
+// Set prescaler, timer must be stopped.
+void _PM_timerPrescale(void *tptr, uint8_t shift) {
+  Tc *tc = (Tc *)tptr; // Cast peripheral address passed in
+  tc->COUNT16.CTRLA.bit.PRESCALER = shift; // DIV1 (0) to DIV16 (4)
+  while (tc->COUNT16.STATUS.bit.SYNCBUSY)
+    ;
+}
+
 #endif // _SAMD21_
 
 // NRF52-SPECIFIC CODE -----------------------------------------------------
@@ -605,6 +696,8 @@ void *_PM_portClearRegister(uint32_t pin) {
 
 // Leave _PM_portToggleRegister(pin) undefined on nRF!
 
+#define _PM_portDirSetRegister(pin) (&digitalPinToPort(pin)->DIRSET)
+
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
 #define _PM_byteOffset(pin) ((g_ADigitalPinMap[pin] & 0x1F) / 8)
 #define _PM_wordOffset(pin) ((g_ADigitalPinMap[pin] & 0x1F) / 16)
@@ -831,6 +924,9 @@ volatile uint16_t *_PM_portClearRegister(uint32_t pin) {
   return 1 + (uint16_t *)&pin_port(pin / 16)->BSRR;
 }
 
+// ...which core.c can use to set RGB data and clear the clock in one write.
+#define _PM_SET_CLEAR_COMBINED
+
 // TODO: was this somehow specific to TIM6?
 #define _PM_timerFreq 42000000
 
@@ -903,6 +999,7 @@ uint32_t _PM_timerStop(void *tptr) {
 #if defined(ARDUINO)
 
 #include "driver/timer.h"
+#include "freertos/semphr.h"
 
 #define _PM_portOutRegister(pin)                                               \
   (volatile uint32_t *)((pin < 32) ? &GPIO.out : &GPIO.out1.val)
@@ -913,6 +1010,10 @@ uint32_t _PM_timerStop(void *tptr) {
 #define _PM_portClearRegister(pin)                                             \
   (volatile uint32_t *)((pin < 32) ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val)
 
+#define _PM_portDirSetRegister(pin)                                            \
+  (volatile uint32_t *)((pin < 32) ? &GPIO.enable_w1ts                         \
+                                   : &GPIO.enable1_w1ts.val)
+
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
 #define _PM_byteOffset(pin) ((pin & 31) / 8)
 #define _PM_wordOffset(pin) ((pin & 31) / 16)
@@ -932,6 +1033,7 @@ uint32_t _PM_timerStop(void *tptr) {
   *set_full = clock;      /* Set clock high */                                 \
   *clear_full = rgbclock; /* Clear RGB data + clock */                         \
   ///< Bitbang one set of RGB data bits to matrix
+#define _PM_PEW_WRITES 4 ///< PORT writes per PEW, see _PM_getRowCost()
 
 // As written, because it's tied to a specific timer right now, the
 // Arduino lib only permits one instance of the Protomatter_core struct,
@@ -952,6 +1054,32 @@ static hw_timer_t *_PM_esp32timer = NULL;
 
 extern IRAM_ATTR void _PM_row_handler(Protomatter_core *core);
 
+// Waiting on a buffer swap by spinning would hold a CPU core at 100% and
+// starve other tasks (e.g. WiFi). Instead the row handler gives a binary
+// semaphore at the end of each frame, and waiting tasks block on it.
+// The timeout is just insurance against a stopped timer.
+static SemaphoreHandle_t _PM_esp32vblank = NULL;
+
+IRAM_ATTR static void _PM_esp32vblankSignal(void) {
+  if (_PM_esp32vblank) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(_PM_esp32vblank, &woken);
+    if (woken) {
+      portYIELD_FROM_ISR();
+    }
+  }
+}
+
+static bool _PM_esp32vblankWait(void) {
+  if (_PM_esp32vblank) {
+    (void)xSemaphoreTake(_PM_esp32vblank, pdMS_TO_TICKS(20) + 1);
+  }
+  return true;
+}
+
+#define _PM_vblankSignal(core) _PM_esp32vblankSignal()
+#define _PM_vblankWait(core) _PM_esp32vblankWait()
+
 // Timer interrupt handler. This, _PM_row_handler() and any functions
 // called by _PM_row_handler() should all have the IRAM_ATTR attribute
 // (RAM-resident functions). This isn't really the ISR itself, but a
@@ -968,6 +1096,9 @@ void _PM_timerInit(void *tptr) {
     *timer = timerBegin(_PM_timerNum, 2, true); // 1:2 prescale, count up
   }
   timerAttachInterrupt(*timer, &_PM_esp32timerCallback, true);
+  if (!_PM_esp32vblank) {
+    _PM_esp32vblank = xSemaphoreCreateBinary();
+  }
 }
 
 // Set timer period, initialize count value to zero, enable timer.
@@ -1159,6 +1290,62 @@ uint32_t _PM_timerStop(void *tptr) {
 
 #endif // __IMXRT1062__ (Teensy 4)
 
+// HOST SIMULATION ---------------------------------------------------------
+
+#if defined(_PM_HOST)
+
+// See extras/host/host.h. Eight 32-bit PORTs with set, clear and (unless
+// _PM_HOST_NO_TOGGLE is defined, to match devices without) toggle
+// registers, or with _PM_HOST_SET_CLEAR_COMBINED, 16-bit PORTs with one
+// STM32-style set/clear register. Register writes are applied at the
+// next sync point, which the clock hold "delays" provide in the
+// data-stuffing loop.
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define _PM_byteOffset(pin) (((pin) % _PM_HOST_PORT_BITS) / 8)
+#define _PM_wordOffset(pin) (((pin) % _PM_HOST_PORT_BITS) / 16)
+#define _PM_HOST_HIGH_HALF 1 ///< Index of upper uint16_t of a uint32_t
+#else
+#define _PM_byteOffset(pin)                                                    \
+  ((_PM_HOST_PORT_BITS - 1 - (pin) % _PM_HOST_PORT_BITS) / 8)
+#define _PM_wordOffset(pin)                                                    \
+  ((_PM_HOST_PORT_BITS - 1 - (pin) % _PM_HOST_PORT_BITS) / 16)
+#define _PM_HOST_HIGH_HALF 0 ///< Index of upper uint16_t of a uint32_t
+#endif
+
+#define _PM_portOutRegister(pin)                                               \
+  (&_PM_hostPorts[(pin) / _PM_HOST_PORT_BITS].out)
+#define _PM_portSetRegister(pin)                                               \
+  (&_PM_hostPorts[(pin) / _PM_HOST_PORT_BITS].set)
+#define _PM_portDirSetRegister(pin)                                            \
+  (&_PM_hostPorts[(pin) / _PM_HOST_PORT_BITS].dirset)
+#if defined(_PM_HOST_SET_CLEAR_COMBINED)
+#define _PM_PORT_TYPE uint16_t
+#define _PM_portClearRegister(pin)                                             \
+  ((volatile uint16_t *)_PM_portSetRegister(pin) + _PM_HOST_HIGH_HALF)
+#define _PM_SET_CLEAR_COMBINED
+#else
+#define _PM_portClearRegister(pin)                                             \
+  (&_PM_hostPorts[(pin) / _PM_HOST_PORT_BITS].clr)
+#if !defined(_PM_HOST_NO_TOGGLE)
+#define _PM_portToggleRegister(pin)                                            \
+  (&_PM_hostPorts[(pin) / _PM_HOST_PORT_BITS].tgl)
+#endif
+#endif
+
+#define _PM_timerFreq _PM_HOST_TIMER_FREQ
+#define _PM_TIMER_DEFAULT (&_PM_hostTimer0)
+#define _PM_timerInit(t) _PM_hostTimerInit(t)
+#define _PM_timerStart(t, period) _PM_hostTimerStart(t, period)
+#define _PM_timerGetCount(t) _PM_hostTimerGetCount(t)
+#define _PM_timerStop(t) _PM_hostTimerStop(t)
+
+#define _PM_clockHoldLow _PM_hostWrite();
+#define _PM_clockHoldHigh _PM_hostWrite();
+#define _PM_vblankWait(core) _PM_hostInterrupt(core)
+
+#endif // _PM_HOST
+
 // DEFAULTS IF NOT DEFINED ABOVE -------------------------------------------
 
 #if !defined(_PM_chunkSize)
@@ -1177,6 +1364,14 @@ uint32_t _PM_timerStop(void *tptr) {
 #define _PM_minMinPeriod 100 ///< Minimum timer interval for least bit
 #endif
 
+#if !defined(_PM_vblankSignal)
+#define _PM_vblankSignal(core) ///< Nothing to signal at end of frame
+#endif
+
+#if !defined(_PM_vblankWait)
+#define _PM_vblankWait(core) true ///< Spin while waiting for end of frame
+#endif
+
 #ifndef _PM_ALLOCATOR
 #define _PM_ALLOCATOR(x) (malloc((x))) ///< Memory alloc call
 #endif
@@ -1191,7 +1386,7 @@ uint32_t _PM_timerStop(void *tptr) {
 
 // ARDUINO SPECIFIC CODE ---------------------------------------------------
 
-#if defined(ARDUINO) || defined(CIRCUITPY)
+#if defined(ARDUINO) || defined(CIRCUITPY) || defined(_PM_HOST)
 
 // 16-bit (565) color conversion functions go here (rather than in the
 // Arduino lib .cpp) because knowledge is required of chunksize and the
@@ -1212,14 +1407,22 @@ uint32_t _PM_timerStop(void *tptr) {
 // matrix chains (matrix data can only be byte-sized if one chain).
 
 // width argument comes from GFX canvas width, which may be less than
-// core's bitWidth (due to padding). height isn't needed, it can be
-// inferred from core->numRowPairs.
+// core's bitWidth (due to padding), or more if columns are doubled (see
+// _PM_setPixelDoubling()), in which case it's only the row stride and
+// just the stored width is converted. height isn't needed, it can be
+// inferred from core->numRowPairs. rows is a bitmask of row pairs to
+// convert, others are left as-is (see _PM_convert_565()).
 __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
                                                     const uint16_t *source,
-                                                    uint16_t width) {
+                                                    uint16_t width,
+                                                    uint32_t rows) {
+  uint16_t stride = width; // Canvas row stride
+  if (width > core->width) {
+    width = core->width;
+  }
   const uint16_t *upperSrc = source; // Canvas top half
   const uint16_t *lowerSrc =
-      source + width * core->numRowPairs;      // " bottom half
+      source + stride * core->numRowPairs;     // " bottom half
   uint8_t *pinMask = (uint8_t *)core->rgbMask; // Pin bitmasks
   uint8_t *dest = (uint8_t *)core->screenData;
   if (core->doubleBuffer) {
@@ -1281,6 +1484,12 @@ __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
   // reading from the canvas source pixels in repeated passes,
   // beginning from the least bit.
   for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (!(rows & (1UL << row))) { // Unchanged, skip row pair
+      dest += bitplaneSize * core->numPlanes;
+      upperSrc += stride;
+      lowerSrc += stride;
+      continue;
+    }
     uint32_t redBit = initialRedBit;
     uint32_t greenBit = initialGreenBit;
     uint32_t blueBit = initialBlueBit;
@@ -1288,7 +1497,7 @@ __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
 #if defined(_PM_portToggleRegister)
       uint8_t prior = clockMask; // Set clock bit on 1st out
 #endif
-      for (uint16_t x = 0; x < width; x++) {
+      for (uint16_t x = 0; x < width;) {
         uint16_t upperRGB = upperSrc[x]; // Pixel in upper half
         uint16_t lowerRGB = lowerSrc[x]; // Pixel in lower half
         uint8_t result = 0;
@@ -1307,9 +1516,17 @@ __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
 #if defined(_PM_portToggleRegister)
         dest[x] = result ^ prior;
         prior = result | clockMask; // Set clock bit on next out
+        uint8_t same = clockMask;   // Only clock toggles in a flat run
 #else
         dest[x] = result;
+        uint8_t same = result;
 #endif
+        // Flat-color run (UI backgrounds, bars, big text): while both
+        // halves' pixels repeat, so does the element, no bit tests needed.
+        while ((++x < width) && (upperSrc[x] == upperRGB) &&
+               (lowerSrc[x] == lowerRGB)) {
+          dest[x] = same;
+        }
       } // end x
       greenBit <<= 1;
       if (plane || (core->numPlanes < 6)) {
@@ -1335,8 +1552,8 @@ __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
 #endif
       dest += bitplaneSize; // Advance one scanline in dest buffer
     }                       // end plane
-    upperSrc += width;      // Advance one scanline in source buffer
-    lowerSrc += width;
+    upperSrc += stride;     // Advance one scanline in source buffer
+    lowerSrc += stride;
   } // end row
 }
 
@@ -1345,10 +1562,14 @@ __attribute__((noinline)) void _PM_convert_565_byte(Protomatter_core *core,
 // same 16-bit word). Some of the comments have been stripped out since it's
 // largely the same operation, but changes are noted.
 void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
-                          uint16_t width) {
-  uint16_t *upperSrc = source;                             // Matrix top half
-  uint16_t *lowerSrc = source + width * core->numRowPairs; // " bottom half
-  uint16_t *pinMask = (uint16_t *)core->rgbMask;           // Pin bitmasks
+                          uint16_t width, uint32_t rows) {
+  uint16_t stride = width; // Canvas row stride
+  if (width > core->width) {
+    width = core->width;
+  }
+  uint16_t *upperSrc = source;                              // Matrix top half
+  uint16_t *lowerSrc = source + stride * core->numRowPairs; // " bottom half
+  uint16_t *pinMask = (uint16_t *)core->rgbMask;            // Pin bitmasks
   uint16_t *dest = (uint16_t *)core->screenData;
   if (core->doubleBuffer) {
     dest += core->bufferSize / core->bytesPerElement * (1 - core->activeBuffer);
@@ -1375,12 +1596,18 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
   // matrix buffer (because each chain is OR'd into place). If a toggle
   // register exists, "clear" really means the clock mask is set in all
   // but the first element on a scanline (per bitplane). If no toggle
-  // register, can just zero everything out.
+  // register, can just zero everything out. Either way, only the row
+  // pairs being converted.
+  uint32_t rowSize = bitplaneSize * core->numPlanes; // Elements per row pair
 #if defined(_PM_portToggleRegister)
   // No per-chain loop is required; one clock bit handles all chains
   uint32_t offset = 0; // Current position in the 'dest' buffer
   uint16_t mask = core->clockMask >> (core->portOffset * 16);
   for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (!(rows & (1UL << row))) {
+      offset += rowSize;
+      continue;
+    }
     for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
       dest[offset++] = 0; // First element of each plane
       for (uint16_t x = 1; x < bitplaneSize; x++) { // All subsequent items
@@ -1389,7 +1616,11 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
     }
   }
 #else
-  memset(dest, 0, core->bufferSize);
+  for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (rows & (1UL << row)) {
+      memset(dest + row * rowSize, 0, rowSize * sizeof(uint16_t));
+    }
+  }
 #endif
 
   dest += pad; // Pad value is in 'elements,' not bytes, so this is OK
@@ -1397,10 +1628,18 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
   // After a set of rows+bitplanes are processed, upperSrc and lowerSrc
   // have advanced halfway down one matrix. This offset is used after
   // each chain to advance them to the start/middle of the next matrix.
-  uint32_t halfMatrixOffset = width * core->numPlanes * core->numRowPairs;
+  // Each chain ORs into the same elements, so dest starts over.
+  uint32_t halfMatrixOffset = stride * core->numRowPairs;
+  uint16_t *chainDest = dest;
 
   for (uint8_t chain = 0; chain < core->parallel; chain++) {
     for (uint8_t row = 0; row < core->numRowPairs; row++) {
+      if (!(rows & (1UL << row))) { // Unchanged, skip row pair
+        dest += rowSize;
+        upperSrc += stride;
+        lowerSrc += stride;
+        continue;
+      }
       uint32_t redBit = initialRedBit;
       uint32_t greenBit = initialGreenBit;
       uint32_t blueBit = initialBlueBit;
@@ -1410,7 +1649,7 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
         // prior is 0 rather than clockMask as in the byte case.
         uint16_t prior = 0;
 #endif
-        for (uint16_t x = 0; x < width; x++) {
+        for (uint16_t x = 0; x < width;) {
           uint16_t upperRGB = upperSrc[x]; // Pixel in upper half
           uint16_t lowerRGB = lowerSrc[x]; // Pixel in lower half
           uint16_t result = 0;
@@ -1431,8 +1670,18 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
 #if defined(_PM_portToggleRegister)
           dest[x] |= result ^ prior; // Bitwise OR
           prior = result;
+#endif
+          // Flat-color run: same bits again. With toggle encoding that's
+          // no change from the prior element, the clock bit's already in.
+#if defined(_PM_portToggleRegister)
+          while ((++x < width) && (upperSrc[x] == upperRGB) &&
+                 (lowerSrc[x] == lowerRGB))
+            ;
 #else
-          dest[x] |= result; // Bitwise OR
+          do {
+            dest[x] |= result; // Bitwise OR
+          } while ((++x < width) && (upperSrc[x] == upperRGB) &&
+                   (lowerSrc[x] == lowerRGB));
 #endif
         } // end x
         greenBit <<= 1;
@@ -1445,12 +1694,13 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
         }
         dest += bitplaneSize; // Advance one scanline in dest buffer
       }                       // end plane
-      upperSrc += width;      // Advance one scanline in source buffer
-      lowerSrc += width;
+      upperSrc += stride;     // Advance one scanline in source buffer
+      lowerSrc += stride;
     }                             // end row
     pinMask += 6;                 // Next chain's RGB pin masks
     upperSrc += halfMatrixOffset; // Advance to next matrix start pos
     lowerSrc += halfMatrixOffset;
+    dest = chainDest;
   }
 }
 
@@ -1458,10 +1708,14 @@ void _PM_convert_565_word(Protomatter_core *core, uint16_t *source,
 // (up to 5), or 1 chain with RGB bits scattered widely about the PORT.
 // Same deal, comments are pared back, see above functions for explanations.
 void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
-                          uint16_t width) {
-  uint16_t *upperSrc = source;                             // Matrix top half
-  uint16_t *lowerSrc = source + width * core->numRowPairs; // " bottom half
-  uint32_t *pinMask = (uint32_t *)core->rgbMask;           // Pin bitmasks
+                          uint16_t width, uint32_t rows) {
+  uint16_t stride = width; // Canvas row stride
+  if (width > core->width) {
+    width = core->width;
+  }
+  uint16_t *upperSrc = source;                              // Matrix top half
+  uint16_t *lowerSrc = source + stride * core->numRowPairs; // " bottom half
+  uint32_t *pinMask = (uint32_t *)core->rgbMask;            // Pin bitmasks
   uint32_t *dest = (uint32_t *)core->screenData;
   if (core->doubleBuffer) {
     dest += core->bufferSize / core->bytesPerElement * (1 - core->activeBuffer);
@@ -1484,10 +1738,15 @@ void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
     initialBlueBit = 0b0000000000000001 << shiftLeft;
   }
 
+  uint32_t rowSize = bitplaneSize * core->numPlanes; // Elements per row pair
 #if defined(_PM_portToggleRegister)
   // No per-chain loop is required; one clock bit handles all chains
   uint32_t offset = 0; // Current position in the 'dest' buffer
   for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (!(rows & (1UL << row))) {
+      offset += rowSize;
+      continue;
+    }
     for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
       dest[offset++] = 0; // First element of each plane
       for (uint16_t x = 1; x < bitplaneSize; x++) { // All subsequent items
@@ -1496,15 +1755,26 @@ void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
     }
   }
 #else
-  memset(dest, 0, core->bufferSize);
+  for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (rows & (1UL << row)) {
+      memset(dest + row * rowSize, 0, rowSize * sizeof(uint32_t));
+    }
+  }
 #endif
 
   dest += pad; // Pad value is in 'elements,' not bytes, so this is OK
 
-  uint32_t halfMatrixOffset = width * core->numPlanes * core->numRowPairs;
+  uint32_t halfMatrixOffset = stride * core->numRowPairs;
+  uint32_t *chainDest = dest;
 
   for (uint8_t chain = 0; chain < core->parallel; chain++) {
     for (uint8_t row = 0; row < core->numRowPairs; row++) {
+      if (!(rows & (1UL << row))) { // Unchanged, skip row pair
+        dest += rowSize;
+        upperSrc += stride;
+        lowerSrc += stride;
+        continue;
+      }
       uint32_t redBit = initialRedBit;
       uint32_t greenBit = initialGreenBit;
       uint32_t blueBit = initialBlueBit;
@@ -1512,7 +1782,7 @@ void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
 #if defined(_PM_portToggleRegister)
         uint32_t prior = 0;
 #endif
-        for (uint16_t x = 0; x < width; x++) {
+        for (uint16_t x = 0; x < width;) {
           uint16_t upperRGB = upperSrc[x]; // Pixel in upper half
           uint16_t lowerRGB = lowerSrc[x]; // Pixel in lower half
           uint32_t result = 0;
@@ -1533,8 +1803,18 @@ void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
 #if defined(_PM_portToggleRegister)
           dest[x] |= result ^ prior; // Bitwise OR
           prior = result;
+#endif
+          // Flat-color run: same bits again. With toggle encoding that's
+          // no change from the prior element, the clock bit's already in.
+#if defined(_PM_portToggleRegister)
+          while ((++x < width) && (upperSrc[x] == upperRGB) &&
+                 (lowerSrc[x] == lowerRGB))
+            ;
 #else
-          dest[x] |= result; // Bitwise OR
+          do {
+            dest[x] |= result; // Bitwise OR
+          } while ((++x < width) && (upperSrc[x] == upperRGB) &&
+                   (lowerSrc[x] == lowerRGB));
 #endif
         } // end x
         greenBit <<= 1;
@@ -1547,13 +1827,64 @@ void _PM_convert_565_long(Protomatter_core *core, uint16_t *source,
         }
         dest += bitplaneSize; // Advance one scanline in dest buffer
       }                       // end plane
-      upperSrc += width;      // Advance one scanline in source buffer
-      lowerSrc += width;
+      upperSrc += stride;     // Advance one scanline in source buffer
+      lowerSrc += stride;
     }                             // end row
     pinMask += 6;                 // Next chain's RGB pin masks
     upperSrc += halfMatrixOffset; // Advance to next matrix start pos
     lowerSrc += halfMatrixOffset;
+    dest = chainDest;
+  }
+
+#if defined(_PM_SET_CLEAR_COMBINED)
+  // Each element so far holds only the RGB bits to set. Put the matching
+  // clear bits (every other RGB bit, plus clock) in the upper half, so
+  // blast_long() can issue data and drop the clock in a single write.
+  dest = (uint32_t *)core->screenData;
+  if (core->doubleBuffer) {
+    dest += core->bufferSize / 4 * (1 - core->activeBuffer);
   }
+  for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    if (rows & (1UL << row)) {
+      for (uint32_t i = row * rowSize; i < (row + 1) * rowSize; i++) {
+        dest[i] |= (core->rgbAndClockMask & ~dest[i]) << 16;
+      }
+    }
+  }
+#endif
+}
+
+// Hash each row pair's canvas pixels (all the canvas rows it displays)
+// and compare against the last conversion, returning a bitmask of row
+// pairs that changed. Drawing code rarely touches every row each frame,
+// and reading the canvas once is much cheaper than converting it. With
+// hashing off (_PM_setRowHashing()) every row counts as changed.
+static uint32_t changed_rows(Protomatter_core *core, const uint16_t *source,
+                             uint16_t width) {
+  if (!core->rowHashing) {
+    return 0xFFFFFFFF >> (32 - core->numRowPairs);
+  }
+  uint16_t stride = width; // Canvas row stride
+  if (width > core->width) {
+    width = core->width;
+  }
+  uint8_t lines = core->parallel * 2; // Canvas rows per row pair
+  uint32_t rows = 0;
+  for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    uint32_t hash = 2166136261UL ^ width; // FNV-1a
+    const uint16_t *src = source + row * stride;
+    for (uint8_t k = 0; k < lines; k++) {
+      for (uint16_t x = 0; x < width; x++) {
+        hash = (hash ^ src[x]) * 16777619UL;
+      }
+      src += stride * core->numRowPairs;
+    }
+    if (!core->hashValid || (hash != core->rowHash[row])) {
+      core->rowHash[row] = hash;
+      rows |= 1UL << row;
+    }
+  }
+  return rows;
 }
 
 void _PM_convert_565(Protomatter_core *core, uint16_t *source, uint16_t width) {
@@ -1561,26 +1892,469 @@ void _PM_convert_565(Protomatter_core *core, uint16_t *source, uint16_t width) {
   // (based on active buffer value, if double-buffering),
   // just need to pass in the canvas buffer address and
   // width in pixels.
+  // Row pair masks here (and in the editing code) are 32 bits: at most 5
+  // address lines (see _PM_init()) means at most 32 row pairs.
+  core->refinePlanes = 0; // Cancels any progressive update
+  uint32_t rows = changed_rows(core, source, width);
+  uint32_t all = 0xFFFFFFFF >> (32 - core->numRowPairs);
+  if ((rows != all) && core->doubleBuffer && core->staleBack) {
+    // Unchanged rows are skipped, so the back buffer needs those from the
+    // displayed one. Just those; the rest are about to be overwritten.
+    uint32_t rowBytes = core->bufferSize / core->numRowPairs;
+    uint8_t *front = (uint8_t *)core->screenData +
+                     core->bufferSize * core->activeBuffer;
+    uint8_t *back = (uint8_t *)core->screenData +
+                    core->bufferSize * (1 - core->activeBuffer);
+    for (uint8_t row = 0; row < core->numRowPairs; row++) {
+      if (!(rows & (1UL << row))) {
+        memcpy(back + row * rowBytes, front + row * rowBytes, rowBytes);
+      }
+    }
+  }
+  core->staleBack = 0;
+  core->hashValid = core->rowHashing; // Matrix buffer now matches rowHash
+  if (!rows) {
+    return;
+  }
   if (core->bytesPerElement == 1) {
-    _PM_convert_565_byte(core, source, width);
+    _PM_convert_565_byte(core, source, width, rows);
   } else if (core->bytesPerElement == 2) {
-    _PM_convert_565_word(core, source, width);
+    _PM_convert_565_word(core, source, width, rows);
+  } else {
+    _PM_convert_565_long(core, source, width, rows);
+  }
+}
+
+// Convert only a rectangular region of the canvas. Rather than yet more
+// copies of the above, this writes matrix elements one pixel at a time
+// through the edit cursor in core.c (_PM_editSeek() etc.), re-encoding
+// each as it goes, so it's slower per pixel than a full conversion but
+// only touches the region.
+
+// Clip a region of the canvas to the matrix. Returns bitmask of row pairs
+// it covers, or 0 if nothing's left.
+static uint32_t clip_565_rect(Protomatter_core *core, uint16_t width,
+                              int16_t *x, int16_t *y, int16_t *w,
+                              int16_t *h) {
+  int16_t height = core->numRowPairs * 2 * core->parallel;
+  if (width > core->width) {
+    width = core->width; // Columns doubled, see _PM_convert_565_byte()
+  }
+  if (*x < 0) {
+    *w += *x;
+    *x = 0;
+  }
+  if (*y < 0) {
+    *h += *y;
+    *y = 0;
+  }
+  if (*x + *w > width) {
+    *w = width - *x;
+  }
+  if (*y + *h > height) {
+    *h = height - *y;
+  }
+  if ((*w <= 0) || (*h <= 0)) {
+    return 0;
+  }
+
+  uint32_t rows = 0; // Bitmask of row pairs touched
+  for (int16_t i = 0; (i < *h) && (i < core->numRowPairs); i++) {
+    rows |= 1UL << ((*y + i) % core->numRowPairs);
+  }
+  return rows;
+}
+
+// Convert a clipped region into the matrix buffer at dest.
+static void convert_565_rect(Protomatter_core *core, uint8_t *dest,
+                             uint16_t *source, uint16_t width, int16_t x,
+                             int16_t y, int16_t w, int16_t h) {
+  uint32_t initialRedBit, initialGreenBit, initialBlueBit;
+  if (core->numPlanes == 6) {
+    initialRedBit = 0b1000000000000000;   // MSB red
+    initialGreenBit = 0b0000000000100000; // LSB green
+    initialBlueBit = 0b0000000000010000;  // MSB blue
+  } else {
+    uint8_t shiftLeft = 5 - core->numPlanes;
+    initialRedBit = 0b0000100000000000 << shiftLeft;
+    initialGreenBit = 0b0000000001000000 << shiftLeft;
+    initialBlueBit = 0b0000000000000001 << shiftLeft;
+  }
+
+  uint8_t bpe = core->bytesPerElement;
+  for (int16_t yy = y; yy < y + h; yy++) {
+    // Row pair, and which 3 RGB pins (chain, upper/lower half) it uses
+    uint8_t row = yy % core->numRowPairs;
+    uint8_t pin = (yy / core->numRowPairs) * 3;
+    uint32_t mask[3];
+    for (uint8_t k = 0; k < 3; k++) {
+      mask[k] = (bpe == 1)   ? ((uint8_t *)core->rgbMask)[pin + k]
+                : (bpe == 2) ? ((uint16_t *)core->rgbMask)[pin + k]
+                             : ((uint32_t *)core->rgbMask)[pin + k];
+    }
+    uint32_t all = mask[0] | mask[1] | mask[2];
+    uint16_t *src = source + yy * width;
+    uint32_t redBit = initialRedBit;
+    uint32_t greenBit = initialGreenBit;
+    uint32_t blueBit = initialBlueBit;
+    for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+      _PM_editCursor ed;
+      _PM_editSeek(core, &ed, dest, row, plane, x);
+      for (int16_t xx = x; xx < x + w; xx++) {
+        uint16_t rgb = src[xx];
+        uint32_t bits = 0;
+        if (rgb & redBit)
+          bits |= mask[0];
+        if (rgb & greenBit)
+          bits |= mask[1];
+        if (rgb & blueBit)
+          bits |= mask[2];
+        (void)_PM_editNext(core, &ed, all, bits);
+      }
+      _PM_editClose(core, &ed);
+      greenBit <<= 1;
+      if (plane || (core->numPlanes < 6)) {
+        redBit <<= 1;
+        blueBit <<= 1;
+      } else {
+        redBit = 0b0000100000000000;
+        blueBit = 0b0000000000000001;
+      }
+    }
+  }
+}
+
+void _PM_convert_565_rect(Protomatter_core *core, uint16_t *source,
+                          uint16_t width, int16_t x, int16_t y, int16_t w,
+                          int16_t h) {
+  uint8_t *dest = (uint8_t *)_PM_editBuffer(core);
+  if (!dest || !clip_565_rect(core, width, &x, &y, &w, &h)) {
+    return;
+  }
+  convert_565_rect(core, dest, source, width, x, y, w, h);
+}
+
+// Convert all regions committed since the last call (see
+// _PM_regionCommit() in core.c) and swap once, so separately-updated
+// parts of the canvas appear together.
+uint8_t _PM_regionShow(Protomatter_core *core, uint16_t *source,
+                       uint16_t width) {
+  if (!core || !core->screenData) {
+    return 0;
+  }
+  uint8_t todo = 0, count = 0;
+  uint8_t seen[_PM_MAX_REGIONS];
+  for (uint8_t r = 0; r < core->numRegions; r++) {
+    // Regions stay pending (producers keep off) until they're converted
+    // and swapped in; only the commits seen here are marked shown then,
+    // so one made meanwhile is picked up next time.
+    seen[r] = core->regionCommits[r];
+    if (seen[r] != core->regionShown[r]) {
+      _PM_region *rg = &core->regions[r];
+      int16_t x = rg->x, y = rg->y, w = rg->w, h = rg->h;
+      if (clip_565_rect(core, width, &x, &y, &w, &h)) {
+        todo |= 1 << r;
+        count++;
+      }
+    }
+  }
+  if (!todo) {
+    // Nothing to convert (a region clipped away entirely still counts as
+    // shown)
+    for (uint8_t r = 0; r < core->numRegions; r++) {
+      core->regionShown[r] = seen[r];
+    }
+    return 0;
+  }
+  uint8_t *dest = (uint8_t *)_PM_editBuffer(core);
+  for (uint8_t r = 0; r < core->numRegions; r++) {
+    if (todo & (1 << r)) {
+      _PM_region *rg = &core->regions[r];
+      int16_t x = rg->x, y = rg->y, w = rg->w, h = rg->h;
+      (void)clip_565_rect(core, width, &x, &y, &w, &h);
+      convert_565_rect(core, dest, source, width, x, y, w, h);
+    }
+  }
+  _PM_swapbuffer_maybe(core);
+  for (uint8_t r = 0; r < core->numRegions; r++) {
+    core->regionShown[r] = seen[r];
+  }
+  return count;
+}
+
+// Apply a batch of XOR deltas to individual pixels. Because each bitplane
+// bit is a straight bit test of the 565 color, XORing a color delta into
+// the matrix bits is the same as converting the new color, and XOR
+// carries through every element encoding without decoding anything: plain
+// data just flips the bits, set/clear-combined flips both halves, and
+// toggle-encoded data (each element is the XOR of neighbors) flips the
+// pixel's element and the one following. Cost is per pixel changed, in
+// any order, regardless of panel size.
+void _PM_convert_565_xor(Protomatter_core *core, const _PM_pixel *pixels,
+                         uint16_t count) {
+  uint8_t *dest = (uint8_t *)_PM_editBuffer(core);
+  if (!dest) {
+    return;
+  }
+  int16_t height = core->numRowPairs * 2 * core->parallel;
+  uint32_t bitplaneSize =
+      _PM_chunkSize * ((core->width + (_PM_chunkSize - 1)) / _PM_chunkSize);
+  uint8_t pad = bitplaneSize - core->width;
+  uint8_t bpe = core->bytesPerElement;
+
+  uint32_t initialRedBit, initialGreenBit, initialBlueBit;
+  if (core->numPlanes == 6) {
+    initialRedBit = 0b1000000000000000;   // MSB red
+    initialGreenBit = 0b0000000000100000; // LSB green
+    initialBlueBit = 0b0000000000010000;  // MSB blue
+  } else {
+    uint8_t shiftLeft = 5 - core->numPlanes;
+    initialRedBit = 0b0000100000000000 << shiftLeft;
+    initialGreenBit = 0b0000000001000000 << shiftLeft;
+    initialBlueBit = 0b0000000000000001 << shiftLeft;
+  }
+
+  for (uint16_t n = 0; n < count; n++) {
+    int16_t x = pixels[n].x, y = pixels[n].y;
+    uint16_t delta = pixels[n].color;
+    if (!delta || (x < 0) || (y < 0) || (x >= core->width) || (y >= height)) {
+      continue;
+    }
+    uint8_t row = y % core->numRowPairs;
+    uint8_t pin = (y / core->numRowPairs) * 3;
+    uint32_t mask[3];
+    for (uint8_t k = 0; k < 3; k++) {
+      mask[k] = (bpe == 1)   ? ((uint8_t *)core->rgbMask)[pin + k]
+                : (bpe == 2) ? ((uint16_t *)core->rgbMask)[pin + k]
+                             : ((uint32_t *)core->rgbMask)[pin + k];
+    }
+    uint32_t redBit = initialRedBit;
+    uint32_t greenBit = initialGreenBit;
+    uint32_t blueBit = initialBlueBit;
+    uint32_t i = row * core->numPlanes * bitplaneSize + pad + x;
+    for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+      uint32_t bits = 0;
+      if (delta & redBit)
+        bits |= mask[0];
+      if (delta & greenBit)
+        bits |= mask[1];
+      if (delta & blueBit)
+        bits |= mask[2];
+      if (bits) {
+#if defined(_PM_SET_CLEAR_COMBINED)
+        bits |= bits << 16; // Flip set and clear bits alike
+#endif
+        // Toggle-encoded: next element toggles from this one, flip it
+        // too (unless last on the line) so the rest of the line is as-is
+#if defined(_PM_portToggleRegister)
+        uint8_t flips = (x < core->width - 1) ? 2 : 1;
+#else
+        uint8_t flips = 1;
+#endif
+        for (uint8_t j = 0; j < flips; j++) {
+          if (bpe == 1) {
+            dest[i + j] ^= bits;
+          } else if (bpe == 2) {
+            ((uint16_t *)dest)[i + j] ^= bits;
+          } else {
+            ((uint32_t *)dest)[i + j] ^= bits;
+          }
+        }
+      }
+      greenBit <<= 1;
+      if (plane || (core->numPlanes < 6)) {
+        redBit <<= 1;
+        blueBit <<= 1;
+      } else {
+        redBit = 0b0000100000000000;
+        blueBit = 0b0000000000000001;
+      }
+      i += bitplaneSize;
+    }
+  }
+}
+
+// PROGRESSIVE CONVERSION: most of what the eye sees is in the upper
+// bitplanes, so for fast-changing content the top few can be converted
+// and shown first, and the lower planes filled in afterward. As with the
+// rect converter, this is one generic function rather than three copies.
+
+// Convert bitplanes planeLo to planeHi-1 from the canvas into buf (the
+// start of one full matrix buffer), leaving other planes as-is. Every
+// element of those lines is written, pad included, encoded as the row
+// handler expects (see _PM_editSeek()). NULL source blanks the planes
+// instead.
+static void convert_565_planes(Protomatter_core *core, const uint16_t *source,
+                               uint16_t width, uint8_t *buf, uint8_t planeLo,
+                               uint8_t planeHi) {
+  uint16_t stride = width; // Canvas row stride
+  if (width > core->width) {
+    width = core->width; // Columns doubled, see _PM_convert_565_byte()
+  }
+  uint32_t elementsPerLine =
+      _PM_chunkSize * ((core->width + (_PM_chunkSize - 1)) / _PM_chunkSize);
+  uint32_t pad = elementsPerLine - width;
+  uint8_t bpe = core->bytesPerElement;
+  uint8_t pins = core->parallel * 6;
+  uint32_t mask[30]; // Pin bitmasks, any element size
+  for (uint8_t k = 0; k < pins; k++) {
+    mask[k] = (bpe == 1)   ? ((uint8_t *)core->rgbMask)[k]
+              : (bpe == 2) ? ((uint16_t *)core->rgbMask)[k]
+                           : ((uint32_t *)core->rgbMask)[k];
+  }
+#if defined(_PM_portToggleRegister)
+  uint32_t clock = _PM_portBitMask(core->clockPin) >>
+                   (core->portOffset * 8 * core->bytesPerElement);
+#endif
+
+  uint32_t initialRedBit, initialGreenBit, initialBlueBit;
+  if (core->numPlanes == 6) {
+    initialRedBit = 0b1000000000000000;   // MSB red
+    initialGreenBit = 0b0000000000100000; // LSB green
+    initialBlueBit = 0b0000000000010000;  // MSB blue
   } else {
-    _PM_convert_565_long(core, source, width);
+    uint8_t shiftLeft = 5 - core->numPlanes;
+    initialRedBit = 0b0000100000000000 << shiftLeft;
+    initialGreenBit = 0b0000000001000000 << shiftLeft;
+    initialBlueBit = 0b0000000000000001 << shiftLeft;
+  }
+
+  for (uint8_t row = 0; row < core->numRowPairs; row++) {
+    uint32_t redBit = initialRedBit;
+    uint32_t greenBit = initialGreenBit;
+    uint32_t blueBit = initialBlueBit;
+    for (uint8_t plane = 0; plane < planeHi; plane++) {
+      if (plane >= planeLo) {
+        uint32_t i = (row * core->numPlanes + plane) * elementsPerLine;
+#if defined(_PM_portToggleRegister)
+        uint32_t prior = 0;
+#endif
+        for (uint32_t e = 0; e < elementsPerLine; e++, i++) {
+          uint32_t bits = 0;
+          if (source && (e >= pad)) {
+            // Each pin trio is one row of pixels: upper then lower half
+            // of each chain, numRowPairs apart in the canvas
+            const uint16_t *src = source + row * stride + (e - pad);
+            for (uint8_t k = 0; k < pins; k += 3) {
+              uint16_t rgb = *src;
+              if (rgb & redBit)
+                bits |= mask[k];
+              if (rgb & greenBit)
+                bits |= mask[k + 1];
+              if (rgb & blueBit)
+                bits |= mask[k + 2];
+              src += stride * core->numRowPairs;
+            }
+          }
+          uint32_t out = bits;
+#if defined(_PM_portToggleRegister)
+          out ^= prior;
+          if (e) {
+            out |= clock; // First element of line has no clock
+          }
+          prior = bits;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+          out |= (core->rgbAndClockMask & ~bits) << 16;
+#endif
+          if (bpe == 1) {
+            buf[i] = out;
+          } else if (bpe == 2) {
+            ((uint16_t *)buf)[i] = out;
+          } else {
+            ((uint32_t *)buf)[i] = out;
+          }
+        }
+      }
+      greenBit <<= 1;
+      if (plane || (core->numPlanes < 6)) {
+        redBit <<= 1;
+        blueBit <<= 1;
+      } else {
+        redBit = 0b0000100000000000;
+        blueBit = 0b0000000000000001;
+      }
+    }
   }
 }
 
+// Convert just the top planes into the back buffer, lower ones blanked.
+void _PM_convert_565_coarse(Protomatter_core *core, uint16_t *source,
+                            uint16_t width, uint8_t planes) {
+  if (!core || !core->screenData) {
+    return;
+  }
+  if ((planes < 1) || (planes > core->numPlanes)) {
+    planes = core->numPlanes;
+  }
+  uint8_t *buf = (uint8_t *)core->screenData;
+  if (core->doubleBuffer) {
+    buf += core->bufferSize * (1 - core->activeBuffer);
+  }
+  uint8_t low = core->numPlanes - planes;
+  convert_565_planes(core, source, width, buf, low, core->numPlanes);
+  convert_565_planes(core, NULL, width, buf, 0, low);
+  core->staleBack = 0; // Every line was written
+  core->hashValid = 0; // Not the full image yet
+  core->refinePlanes = low;
+}
+
+// Fill in the next lower planes after _PM_convert_565_coarse(). The row
+// handler may be issuing a line while it's rewritten, and with toggle
+// encoding a half-new line XORs new elements onto stale ones: garbage to
+// the end of that line for a refresh. So if double-buffered, this builds
+// the refined frame in the back buffer (planes already done are copied
+// from the displayed one, lower planes are blank there too) for the
+// caller to swap in. Single-buffered, it has to go straight into the
+// displayed buffer and a line caught mid-write glitches in that (low,
+// short) plane for one refresh.
+uint8_t _PM_convert_565_refine(Protomatter_core *core, uint16_t *source,
+                               uint16_t width, uint8_t planes) {
+  if (!core || !core->screenData || !core->refinePlanes) {
+    return 0;
+  }
+  uint8_t *buf = (uint8_t *)core->screenData;
+  uint8_t hi = core->refinePlanes;
+  uint8_t lo = (planes < hi) ? hi - planes : 0;
+  if (core->doubleBuffer) {
+    uint8_t *front = buf + core->bufferSize * core->activeBuffer;
+    buf += core->bufferSize * (1 - core->activeBuffer);
+    uint32_t lineBytes =
+        _PM_chunkSize * ((core->width + (_PM_chunkSize - 1)) / _PM_chunkSize) *
+        core->bytesPerElement;
+    for (uint8_t row = 0; row < core->numRowPairs; row++) {
+      uint32_t start = row * core->numPlanes * lineBytes;
+      memcpy(buf + start, front + start, lo * lineBytes);
+      start += hi * lineBytes;
+      memcpy(buf + start, front + start, (core->numPlanes - hi) * lineBytes);
+    }
+    core->staleBack = 0; // Every line was written
+  }
+  convert_565_planes(core, source, width, buf, lo, hi);
+  core->refinePlanes = lo;
+  return lo;
+}
+
 void _PM_swapbuffer_maybe(Protomatter_core *core) {
   if (core->doubleBuffer) {
+    // Whatever happens below, the buffer converted into next is now a
+    // frame behind; partial updates (see _PM_editBuffer()) need a copy.
+    core->staleBack = 1;
+    if (core->paused || !core->running) {
+      // Refresh is suspended (see _PM_pause()) or stopped, the ISR won't
+      // be around to do the swap. Nothing's being shown, so just flip it
+      // here.
+      core->activeBuffer = 1 - core->activeBuffer;
+      return;
+    }
     core->swapBuffers = 1;
     // To avoid overwriting data on the matrix, don't return
     // until the timer ISR has performed the swap at the right time.
     while (core->swapBuffers)
-      ;
+      (void)_PM_vblankWait(core);
   }
 }
 
-#endif // ARDUINO || CIRCUITPYTHON
+#endif // ARDUINO || CIRCUITPYTHON || _PM_HOST
 
 #ifndef _PM_PORT_TYPE
 #define _PM_PORT_TYPE uint32_t ///< PORT register size/type
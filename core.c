@@ -53,8 +53,14 @@
 // Time (in microseconds) to pause following any change in address lines
 // (individually or collectively). Some matrices respond slowly there...
 // must pause on change for matrix to catch up. Defined here (rather than
-// arch.h) because it's not architecture-specific.
-#define _PM_ROW_DELAY 8 ///< Delay time between row address line changes (ms)
+// arch.h) because it's not architecture-specific. This is the default,
+// panels that settle faster can use less, see _PM_setPanelProfile().
+#define _PM_ROW_DELAY 8 ///< Delay time between row address line changes (us)
+
+// Panel timing profiles, see _PM_setPanelProfile(). The 1 us OE delay
+// after starting the timer is needed on Teensy 4, so both keep it.
+const _PM_panelProfile _PM_panelDefault = {_PM_ROW_DELAY, 1};
+const _PM_panelProfile _PM_panelFast = {0, 1};
 
 // These are the lowest-level functions for issing data to matrices.
 // There are three versions because it depends on how the six RGB data bits
@@ -71,6 +77,15 @@
 static void blast_byte(Protomatter_core *core, uint8_t *data);
 static void blast_word(Protomatter_core *core, uint16_t *data);
 static void blast_long(Protomatter_core *core, uint32_t *data);
+static void blast_plane(Protomatter_core *core);
+static uint32_t plane_period(Protomatter_core *core, uint8_t plane);
+static void set_min_period(Protomatter_core *core);
+static void timer_start(Protomatter_core *core, uint32_t period);
+static uint32_t timer_stop(Protomatter_core *core);
+static uint32_t timer_count(Protomatter_core *core);
+static uint32_t timer_unwrap(Protomatter_core *core, uint32_t count);
+static bool row_step(Protomatter_core *core, bool interrupted);
+static void fit_timer(Protomatter_core *core);
 
 #define _PM_clearReg(x)                                                        \
   (*(volatile _PM_PORT_TYPE *)((x).clearReg) =                                 \
@@ -79,6 +94,38 @@ static void blast_long(Protomatter_core *core, uint32_t *data);
   (*(volatile _PM_PORT_TYPE *)((x).setReg) =                                   \
        ((x).bit)) ///< Set non-RGB-data-or-clock control line (_PM_pin type)
 
+// Full-PORT bitmask of all RGB data pins plus clock. Unlike the
+// rgbAndClockMask element (which may be pre-shifted to an 8- or 16-bit
+// value for the data-stuffing loops), this is always PORT-aligned, for
+// use with the set and clear registers outside the innermost loops.
+static _PM_PORT_TYPE rgbclock_bits(Protomatter_core *core) {
+  _PM_PORT_TYPE bits = _PM_portBitMask(core->clockPin);
+  for (uint8_t i = 0; i < core->parallel * 6; i++) {
+    bits |= _PM_portBitMask(core->rgbPins[i]);
+  }
+  return bits;
+}
+
+// Estimate minimum bitplane #0 period for _PM_MAX_REFRESH_HZ rate,
+// given the sum of all plane weights (2^numPlanes-1 if binary).
+static void set_min_period(Protomatter_core *core) {
+  uint32_t minPeriodPerFrame = _PM_timerFreq / _PM_MAX_REFRESH_HZ;
+  uint32_t minPeriodPerLine =
+      minPeriodPerFrame / (core->numRowPairs << core->doubleRows);
+  uint32_t weightSum = 0;
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    weightSum += core->planeWeight[p];
+  }
+  core->minPeriod = (minPeriodPerLine << 8) / weightSum;
+  if (core->minPeriod < _PM_minMinPeriod) {
+    core->minPeriod = _PM_minMinPeriod;
+  }
+  // Actual frame rate may be lower than this...it's only an estimate
+  // and does not factor in things like address line selection delays
+  // or interrupt overhead. That's OK, just don't want to exceed this
+  // rate, as it'll eat all the CPU cycles.
+}
+
 // Validate and populate vital elements of core structure.
 // Does NOT allocate core struct -- calling function must provide that.
 // (In the Arduino C++ library, it’s part of the Protomatter class.)
@@ -120,6 +167,33 @@ ProtomatterStatus _PM_init(Protomatter_core *core, uint16_t bitWidth,
   core->doubleBuffer = doubleBuffer;
   core->addr = NULL;
   core->screenData = NULL;
+  core->planeTicks = NULL;
+  core->rowHash = NULL;
+  core->paletteBits = NULL;
+  core->paletteSize = 0;
+  core->vblankCount = 0;
+  core->swapInterval = 0;
+  core->targetFps = 0;
+  core->directOut = 0;
+  core->longElements = 0;
+  core->doubleRows = 0;
+  core->doubleColumns = 0;
+  core->timerShift = 0;
+  core->staleBack = 0;
+  core->refinePlanes = 0;
+  core->hashValid = 0;
+  core->rowHashing = 1;
+  core->shiftSignal = NULL;
+  core->shiftPending = 0;
+  core->shifting = 0;
+  core->lateShifts = 0;
+  core->lateTicks = 0;
+  core->timerPeriod = 0;
+  core->entryEighths = core->shiftTicks = core->overrunTicks = 0;
+  core->coalesce = 0;
+  core->running = 0;
+  _PM_regionClear(core);
+  _PM_setPanelProfile(core, &_PM_panelDefault);
 
   // Make a copy of the rgbList and addrList tables in case they're
   // passed from local vars on the stack or some other non-persistent
@@ -208,9 +282,20 @@ ProtomatterStatus _PM_begin(Protomatter_core *core) {
     core->bytesPerElement = 4; // Use 32-bit PORT accesses.
     break;
   }
+#if defined(_PM_SET_CLEAR_COMBINED)
+  // Set and clear bits share one register; elements carry both halves
+  // (see _PM_convert_565_long()), which requires 32 bits regardless.
+  core->bytesPerElement = 4;
+#endif
+  if (core->longElements) {
+    // User asked for 32-bit elements regardless of pin layout (see
+    // _PM_setLongElements()), trading RAM for a shift-free inner loop.
+    core->bytesPerElement = 4;
+  }
 
   // Planning for screen data allocation...
-  core->numRowPairs = 1 << core->numAddressLines;
+  // If rows are doubled, each stored row pair feeds two physical ones.
+  core->numRowPairs = (1 << core->numAddressLines) >> core->doubleRows;
   uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
   uint16_t columns = chunks * _PM_chunkSize; // Padded matrix width
   uint32_t screenBytes =
@@ -220,17 +305,33 @@ ProtomatterStatus _PM_begin(Protomatter_core *core) {
   if (core->doubleBuffer)
     screenBytes *= 2; // Total for matrix buffer(s)
   uint32_t rgbMaskBytes = core->parallel * 6 * core->bytesPerElement;
+  uint32_t weightBytes = core->numPlanes * sizeof(uint16_t);
+  // Plane timing measurements go last, rounded up to uint32_t alignment,
+  // followed by canvas row hashes (see _PM_convert_565()).
+  uint32_t ticksOffset = (screenBytes + rgbMaskBytes + weightBytes + 3) & ~3;
+  uint32_t ticksBytes =
+      (core->numPlanes + core->numRowPairs) * sizeof(uint32_t);
 
   // Allocate matrix buffer(s). Don't worry about the return type...
   // though we might be using words or longs for certain pin configs,
   // _PM_ALLOCATOR() by definition always aligns to the longest type.
   if (!(core->screenData =
-            (uint8_t *)_PM_ALLOCATOR(screenBytes + rgbMaskBytes))) {
+            (uint8_t *)_PM_ALLOCATOR(ticksOffset + ticksBytes))) {
     return PROTOMATTER_ERR_MALLOC;
   }
 
-  // rgbMask data follows the matrix buffer(s)
+  // rgbMask data follows the matrix buffer(s), then plane weights.
+  // rgbMaskBytes is always even, so the weights are uint16_t-aligned.
   core->rgbMask = core->screenData + screenBytes;
+  core->planeWeight = (uint16_t *)((uint8_t *)core->rgbMask + rgbMaskBytes);
+  core->planeTicks = (uint32_t *)((uint8_t *)core->screenData + ticksOffset);
+  core->rowHash = core->planeTicks + core->numPlanes;
+  core->hashValid = 0;
+  // Default to binary weighting, each plane twice the period of the prior
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    core->planeWeight[p] = 256 << p;
+    core->planeTicks[p] = 0;
+  }
 
 #if !defined(_PM_portToggleRegister)
   // Clear entire screenData buffer so there's no cruft in any pad bytes
@@ -296,6 +397,12 @@ ProtomatterStatus _PM_begin(Protomatter_core *core) {
     for (uint32_t i = 0; i < elements; i++) {
       ((uint32_t *)core->screenData)[i] = core->clockMask;
     }
+#elif defined(_PM_SET_CLEAR_COMBINED)
+    // Blank elements clear all RGB bits + clock, set nothing
+    uint32_t elements = screenBytes / 4;
+    for (uint32_t i = 0; i < elements; i++) {
+      ((uint32_t *)core->screenData)[i] = core->rgbAndClockMask << 16;
+    }
 #endif
     for (uint8_t i = 0; i < core->parallel * 6; i++) {
       ((uint32_t *)core->rgbMask)[i] = // Pin bitmasks are 32-bit
@@ -303,21 +410,12 @@ ProtomatterStatus _PM_begin(Protomatter_core *core) {
     }
   }
 
-  // Estimate minimum bitplane #0 period for _PM_MAX_REFRESH_HZ rate.
-  uint32_t minPeriodPerFrame = _PM_timerFreq / _PM_MAX_REFRESH_HZ;
-  uint32_t minPeriodPerLine = minPeriodPerFrame / core->numRowPairs;
-  core->minPeriod = minPeriodPerLine / ((1 << core->numPlanes) - 1);
-  if (core->minPeriod < _PM_minMinPeriod) {
-    core->minPeriod = _PM_minMinPeriod;
-  }
-  // Actual frame rate may be lower than this...it's only an estimate
-  // and does not factor in things like address line selection delays
-  // or interrupt overhead. That's OK, just don't want to exceed this
-  // rate, as it'll eat all the CPU cycles.
+  set_min_period(core);
+
   // Make a wild guess for the initial bit-zero interval. It's okay
   // that this is off, code adapts to actual timer results pretty quick.
 
-  core->bitZeroPeriod = core->width * 5; // Initial guesstimate
+  core->bitZeroPeriod = (core->width << core->doubleColumns) * 5; // Guess
 
   core->activeBuffer = 0;
 
@@ -371,6 +469,12 @@ ProtomatterStatus _PM_begin(Protomatter_core *core) {
 #if defined(_PM_portToggleRegister)
   core->toggleReg = (uint8_t *)_PM_portToggleRegister(core->clockPin);
 #endif
+  core->outReg = (uint8_t *)_PM_portOutRegister(core->clockPin);
+#if defined(_PM_portDirSetRegister)
+  core->dirSetReg = (uint8_t *)_PM_portDirSetRegister(core->clockPin);
+#else
+  core->dirSetReg = NULL;
+#endif
 
   // Reset plane/row counters, config and start timer
   _PM_resume(core);
@@ -388,23 +492,31 @@ void _PM_stop(Protomatter_core *core) {
     if (!core->screenData) {
       return;
     }
-    while (core->swapBuffers)
-      ;                         // Wait for any pending buffer swap
-    _PM_timerStop(core->timer); // Halt timer
-    _PM_setReg(core->oe);       // Set OE HIGH (disable output)
+    while (core->swapBuffers && !core->paused)
+      (void)_PM_vblankWait(core); // Wait for any pending buffer swap
+    _PM_timerStop(core->timer);   // Halt timer
+    _PM_setReg(core->oe);         // Set OE HIGH (disable output)
+    core->running = 0;            // Nothing to wait on from here
+    core->paused = 0;
+    core->shiftPending = 0; // Any deferred shift is moot
     // So, in PRINCIPLE, setting OE high would be sufficient...
     // but in case that pin is shared with another function such
     // as the onloard LED (which pulses during bootloading) let's
     // also clear out the matrix shift registers for good measure.
-    // Set all RGB pins LOW...
-    for (uint8_t i = 0; i < core->parallel * 6; i++) {
-      _PM_pinLow(core->rgbPins[i]);
-    }
+    // This goes straight to the PORT registers; a digitalWrite() per
+    // column adds up to milliseconds on long chains.
+    volatile _PM_PORT_TYPE *set = (volatile _PM_PORT_TYPE *)core->setReg;
+    volatile _PM_PORT_TYPE *clear = (volatile _PM_PORT_TYPE *)core->clearReg;
+    _PM_PORT_TYPE clock = _PM_portBitMask(core->clockPin);
+    // Set all RGB pins (and clock) LOW...
+    *clear = rgbclock_bits(core);
+    _PM_clockHoldLow;
     // Clock out bits (just need to toggle clock with RGBs held low)
-    for (uint32_t i = 0; i < core->width; i++) {
-      _PM_pinHigh(core->clockPin);
+    for (uint32_t i = 0; i < (uint32_t)(core->width << core->doubleColumns);
+         i++) {
+      *set = clock;
       _PM_clockHoldHigh;
-      _PM_pinLow(core->clockPin);
+      *clear = clock;
       _PM_clockHoldLow;
     }
     // Latch data
@@ -417,13 +529,88 @@ void _PM_resume(Protomatter_core *core) {
   if ((core)) {
     // Init plane & row to max values so they roll over on 1st interrupt
     core->plane = core->numPlanes - 1;
-    core->row = core->numRowPairs - 1;
-    core->prevRow = (core->numRowPairs > 1) ? (core->row - 1) : 1;
+    // (row counts physical row pairs, see _PM_setPixelDoubling())
+    core->row = (core->numRowPairs << core->doubleRows) - 1;
+    core->prevRow = core->row ? (core->row - 1) : 1;
     core->swapBuffers = 0;
     core->frameCount = 0;
+    core->swapVblank = core->vblankCount;
+    core->dropped = core->duplicated = 0;
+    core->frameTimed = 0; // Until the next vblank
+    core->shiftPending = 0;
+    core->lateTicks = 0;
+    core->entryEighths = core->shiftTicks = core->overrunTicks = 0;
+    if (core->planeTicks) {
+      for (uint8_t p = 0; p < core->numPlanes; p++) {
+        core->planeTicks[p] = 0; // Start timing measurements over
+      }
+    }
+    core->paused = 0;
+    core->running = 1;
 
     _PM_timerInit(core->timer);        // Configure timer
-    _PM_timerStart(core->timer, 1000); // Start timer
+    core->timerShift = 0;              // (init leaves it unprescaled)
+    timer_start(core, 1000);           // Start timer
+  }
+}
+
+// Briefly suspend refresh, e.g. to share RGB data and clock pins with
+// another bus. Unlike _PM_stop(), no data is clocked out and plane, row,
+// bitZeroPeriod and buffers are left as-is, so _PM_unpause() can carry on
+// mid-frame. This is meant to be quick enough to wrap around individual
+// SPI flash or SD card transactions.
+void _PM_pause(Protomatter_core *core) {
+  if ((core) && core->screenData && !core->paused) {
+    core->paused = 1; // ISR won't restart timer or enable output
+    // Snapshot only once paused: a row handler that runs from here on
+    // leaves the output off. One that ran before has restarted the timer
+    // on the plane it loaded, which is the one this count then applies to.
+    uint8_t plane = core->plane, row = core->row;
+    uint32_t count = timer_stop(core);
+    _PM_setReg(core->oe); // Set OE HIGH (disable output)
+    // If the row handler slipped in just before the timer stopped, the
+    // newly-loaded plane hasn't been displayed at all; the handler sets
+    // pausedCount to 0 in that case, don't overwrite it.
+    if ((plane == core->plane) && (row == core->row)) {
+      core->pausedCount = count;
+    }
+  }
+}
+
+void _PM_unpause(Protomatter_core *core) {
+  if ((core) && core->paused) {
+    // The shared bus may have left RGB/clock pins as inputs and clocked
+    // junk into the matrix shift registers. Set the pins LOW, make them
+    // outputs and reissue the plane that was waiting to latch. They're
+    // all on one PORT, so where there's a direction-set register that's
+    // a single write; pinMode() and the like can take microseconds each.
+    _PM_PORT_TYPE bits = rgbclock_bits(core);
+    *(volatile _PM_PORT_TYPE *)core->clearReg = bits;
+    if (core->dirSetReg) {
+      *(volatile _PM_PORT_TYPE *)core->dirSetReg = bits;
+    } else {
+      for (uint8_t i = 0; i < core->parallel * 6; i++) {
+        _PM_pinOutput(core->rgbPins[i]);
+      }
+      _PM_pinOutput(core->clockPin);
+    }
+    core->shiftPending = 0; // Issued here instead
+    blast_plane(core);
+
+    // Finish out the interval of the plane being displayed when paused.
+    // Plane 0 always gets its full period, since that's the interval
+    // the row handler measures to adapt bitZeroPeriod (and it's short).
+    uint8_t shownPlane = core->plane ? core->plane - 1 : core->numPlanes - 1;
+    uint32_t period = plane_period(core, shownPlane);
+    if (shownPlane && (core->pausedCount < period)) {
+      period -= core->pausedCount;
+      if (period < core->minPeriod) {
+        period = core->minPeriod;
+      }
+    }
+    core->paused = 0;
+    timer_start(core, period);
+    _PM_clearReg(core->oe); // Enable LED output
   }
 }
 
@@ -436,6 +623,11 @@ void _PM_free(Protomatter_core *core) {
       _PM_FREE(core->screenData);
     if (core->addr)
       _PM_FREE(core->addr);
+    if (core->paletteBits) {
+      _PM_FREE(core->paletteBits);
+      core->paletteBits = NULL;
+      core->paletteSize = 0;
+    }
     if (core->rgbPins) {
       _PM_FREE(core->rgbPins);
       core->rgbPins = NULL;
@@ -453,6 +645,54 @@ void _PM_free(Protomatter_core *core) {
 // specific section of arch.h. Sorry. :/
 // Any functions called by this function should also be IRAM_ATTR'd.
 IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
+  // Usually one row/plane per interrupt, but several if planes are very
+  // short, see end of row_step().
+  for (bool interrupted = true; row_step(core, interrupted);) {
+    interrupted = false;
+  }
+}
+
+// Frame pacing (see _PM_setFrameRate()): given the timer ticks the last
+// refresh took, pick the whole number of refreshes per paced frame that's
+// nearest the target rate. It only changes once the refresh rate is well
+// past the midpoint between two counts, so a rate right around there
+// doesn't flip back and forth (which would judder). Ticks between stopping
+// and restarting the timer in the row handler aren't counted; that's a
+// few percent at most, and rounding to whole refreshes absorbs it.
+IRAM_ATTR static void pace_frames(Protomatter_core *core, uint32_t ticks) {
+  if (!ticks) {
+    return;
+  }
+  // First full refresh after _PM_setFrameRate() is taken as-is
+  core->refreshTicks =
+      core->refreshTicks ? ((core->refreshTicks * 7) + ticks) / 8 : ticks;
+  uint32_t refreshHz = _PM_timerFreq / core->refreshTicks;
+  uint32_t fps = core->targetFps;
+  uint32_t now = core->swapInterval * fps;
+  if ((refreshHz + fps * 3 / 4 < now) || (refreshHz > now + fps * 3 / 4)) {
+    uint32_t interval = (refreshHz + fps / 2) / fps;
+    core->swapInterval = (interval < 1) ? 1 : (interval > 255) ? 255 : interval;
+  }
+}
+
+IRAM_ATTR static bool row_step(Protomatter_core *core, bool interrupted) {
+
+  // If data is shifted outside this handler (see _PM_setDeferredShift()),
+  // it may not be finished yet. Can't latch a partial line, so if it's
+  // mid-shift, keep showing the current plane a little longer (that time
+  // still counts toward the plane's measured period). If it never
+  // started, shift it here; output's still on meanwhile.
+  if (core->shifting) {
+    core->lateTicks += timer_unwrap(core, timer_stop(core));
+    core->lateShifts++;
+    timer_start(core, core->minPeriod);
+    return false;
+  }
+  if (core->shiftPending) {
+    core->shiftPending = 0;
+    core->lateShifts++;
+    blast_plane(core);
+  }
 
   _PM_setReg(core->oe); // Disable LED output
 
@@ -468,21 +708,50 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   _PM_clearReg(core->latch);
 
   _PM_setReg(core->latch);
-  // Stop timer, save count value at stop
-  uint32_t elapsed = _PM_timerStop(core->timer);
+  // Stop timer, save count value at stop (plus any extension, above).
+  // When coalescing, the timer ran as a stopwatch and didn't expire.
+  uint32_t count = timer_stop(core);
+  uint32_t shown = interrupted ? timer_unwrap(core, count) : count;
+  uint32_t elapsed = shown + core->lateTicks;
+  // For bitZeroPeriod, below: how far the timer ran past its period
+  uint32_t adapt =
+      (interrupted ? shown - core->timerPeriod : count) + core->lateTicks;
+  core->lateTicks = 0;
+  core->frameTicks += elapsed;
+  // How late the interrupt ran vs. the period it was set for, less any
+  // part of that the previous call itself ran over (see end of function):
+  // what's left is interrupt entry time (see _PM_getRowCost()).
+  if (interrupted) {
+    uint32_t late = shown - core->timerPeriod; // Unwrapped, >= period
+    late = (late > core->overrunTicks) ? late - core->overrunTicks : 0;
+    // Kept in 1/8 ticks: entry is only a few ticks, which the usual
+    // (x * 7 + new) / 8 filter would round away to nothing.
+    core->entryEighths += late - core->entryEighths / 8;
+  }
   uint8_t prevPlane = core->plane; // Save that plane # for later timing
   _PM_clearReg(core->latch);       // (split to add a few cycles)
 
+  // Keep a filtered measure of each plane's actual display time, for
+  // _PM_getPlaneTiming(). The plane that just finished is the one before
+  // prevPlane. First sample following _PM_resume() is taken as-is.
+  uint8_t shownPlane = prevPlane ? prevPlane - 1 : core->numPlanes - 1;
+  uint32_t *ticks = &core->planeTicks[shownPlane];
+  *ticks = *ticks ? ((*ticks * 7) + elapsed) / 8 : elapsed;
+
   // If plane 0 just finished being displayed (plane 1 was loaded on prior
   // pass, or there's only one plane...I know, it's confusing), take note
   // of the elapsed timer value, for subsequent bitplane timing (each
   // plane period is double the previous). Value is filtered slightly to
-  // avoid jitter.
+  // avoid jitter. This uses only how far plane 0 ran past its period
+  // (what timers that wrap, most here, read; see timer_unwrap()), so on
+  // any timer bitZeroPeriod stays near minPeriod instead of creeping up
+  // by the interrupt latency every row.
   if ((prevPlane == 1) || (core->numPlanes == 1)) {
-    core->bitZeroPeriod = ((core->bitZeroPeriod * 7) + elapsed) / 8;
+    core->bitZeroPeriod = ((core->bitZeroPeriod * 7) + adapt) / 8;
     if (core->bitZeroPeriod < core->minPeriod) {
       core->bitZeroPeriod = core->minPeriod;
     }
+    fit_timer(core); // Longest plane period may have changed
   }
 
   if (prevPlane == 0) { // Plane 0 just finished loading
@@ -504,7 +773,9 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
         }
       }
       *(volatile _PM_PORT_TYPE *)core->addrPortToggle = newBits ^ priorBits;
-      _PM_delayMicroseconds(_PM_ROW_DELAY);
+      if (core->rowDelay) {
+        _PM_delayMicroseconds(core->rowDelay);
+      }
     } else {
 #endif
       // Configure row address lines individually, making changes
@@ -517,7 +788,9 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
           } else { // Set addr line low
             _PM_clearReg(core->addr[line]);
           }
-          _PM_delayMicroseconds(_PM_ROW_DELAY);
+          if (core->rowDelay) {
+            _PM_delayMicroseconds(core->rowDelay);
+          }
         }
       }
 #if defined(_PM_portToggleRegister)
@@ -529,14 +802,29 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   // Advance bitplane index and/or row as necessary
   if (++core->plane >= core->numPlanes) {   // Next data bitplane, or
     core->plane = 0;                        // roll over bitplane to start
-    if (++core->row >= core->numRowPairs) { // Next row, or
-      core->row = 0;                        // roll over row to start
-      // Switch matrix buffers if due (only if double-buffered)
-      if (core->swapBuffers) {
+    // Next row (physical, see _PM_setPixelDoubling()), or
+    if (++core->row >= (core->numRowPairs << core->doubleRows)) {
+      core->row = 0; // roll over row to start
+      core->frameCount++;
+      core->vblankCount++;
+      // Switch matrix buffers if due (only if double-buffered). If frame
+      // pacing, the current buffer is held for swapInterval refreshes.
+      uint32_t shown = core->vblankCount - core->swapVblank;
+      if (core->swapBuffers && (shown >= core->swapInterval)) {
         core->activeBuffer = 1 - core->activeBuffer;
         core->swapBuffers = 0; // Swapped!
+        core->swapVblank = core->vblankCount;
+        if (core->swapInterval && (shown > core->swapInterval)) {
+          core->duplicated += shown - core->swapInterval;
+          core->dropped += shown / core->swapInterval - 1;
+        }
       }
-      core->frameCount++;
+      if (core->frameTimed && core->targetFps) {
+        pace_frames(core, core->frameTicks);
+      }
+      core->frameTicks = 0;
+      core->frameTimed = 1;
+      _PM_vblankSignal(core); // Wake anything waiting on the swap or frame
     }
   }
 
@@ -544,15 +832,165 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   // 'prevPlane' is the previously-loaded data, which gets displayed
   // now while the next plane data is loaded.
 
-  // Set timer and enable LED output for data loaded on PRIOR pass:
-  _PM_timerStart(core->timer, core->bitZeroPeriod << prevPlane);
-  _PM_delayMicroseconds(1); // Appease Teensy4
-  _PM_clearReg(core->oe);   // Enable LED output
+  // Interrupt coalescing (opt-in): if the plane about to be shown ends
+  // no later than interrupt exit & entry after the next plane's data is
+  // shifted out, it's cheaper to wait it out here and go straight on to
+  // the next than to return and take another interrupt.
+  // The top plane always returns, so the handler does too. The timer then
+  // serves as a stopwatch, started with the top plane's period so it
+  // won't fire meanwhile.
+  // Handler cost is measured either way, just not with data shifted
+  // elsewhere (or not at all, if paused).
+  uint32_t period = plane_period(core, prevPlane);
+  bool measure = !core->paused && !core->shiftSignal;
+  bool coalesce = measure && core->coalesce &&
+                  (prevPlane < core->numPlanes - 1) &&
+                  (period * 4 <= core->shiftTicks * 4 + core->entryEighths);
+
+  // Set timer and enable LED output for data loaded on PRIOR pass
+  // (unless _PM_pause() got in ahead of us, in which case leave the
+  // output off and note that this plane hasn't been displayed yet):
+  if (!core->paused) {
+    timer_start(core, coalesce ? plane_period(core, core->numPlanes - 1)
+                               : period);
+    if (core->oeDelay) {
+      _PM_delayMicroseconds(core->oeDelay); // Appease Teensy4
+    }
+    _PM_clearReg(core->oe); // Enable LED output
+  } else {
+    core->pausedCount = 0;
+  }
+
+  if (core->shiftSignal) {
+    core->shiftPending = 1; // _PM_row_shift() will issue it
+    core->shiftSignal();
+  } else {
+    blast_plane(core);
+  }
+
+  // 'plane' data is now loaded (or will be, by _PM_row_shift()), will be
+  // shown on NEXT pass
+
+  if (measure) {
+    // Time from timer start to data shifted out. Only read while the
+    // timer has the top plane's period, the longest, or it might have
+    // wrapped meanwhile (see timer_unwrap()). Every plane's shift takes
+    // about as long, so that also gives how far this call runs past a
+    // shorter period if returning (the next interrupt is then pending
+    // already, which the next call mustn't count as entry time).
+    if (coalesce || (prevPlane == core->numPlanes - 1)) {
+      uint32_t done = timer_count(core);
+      core->shiftTicks = ((core->shiftTicks * 7) + done) / 8;
+    }
+    uint32_t shift = core->shiftTicks;
+    core->overrunTicks = (!coalesce && (shift > period)) ? shift - period : 0;
+  }
+  if (coalesce) {
+    while (timer_count(core) < period)
+      ;
+    core->timerPeriod = period; // As if started with it
+  }
+  return coalesce;
+}
+
+// Issue the next plane's data if the row handler left it pending. Data
+// can go out any time before the next row handler call, e.g. from a
+// lower-priority interrupt, so the timer interrupt stays short.
+IRAM_ATTR void _PM_row_shift(Protomatter_core *core) {
+  core->shifting = 1; // Row handler won't latch meanwhile
+  if (core->shiftPending && !core->paused) {
+    core->shiftPending = 0;
+    blast_plane(core);
+  }
+  core->shifting = 0;
+}
+
+// Timer interval for displaying a given bitplane: bitZeroPeriod (adapted
+// to actual timing in the row handler) scaled by the plane's weight, an
+// 8.8 fixed-point multiple of plane 0's period.
+IRAM_ATTR static uint32_t plane_period(Protomatter_core *core,
+                                       uint8_t plane) {
+  return (core->bitZeroPeriod * core->planeWeight[plane]) >> 8;
+}
+
+// Plane periods are all in _PM_timerFreq ticks. If the arch's timer has a
+// limited range (_PM_timerMaxCount in arch.h), it may be running
+// prescaled (see fit_timer()), these convert to and from that.
+IRAM_ATTR static void timer_start(Protomatter_core *core, uint32_t period) {
+  core->timerPeriod = period;
+#if defined(_PM_timerMaxCount)
+  period >>= core->timerShift;
+  if (!period) {
+    period = 1;
+  }
+  core->timerPeriod = period << core->timerShift; // As the timer has it
+#endif
+  _PM_timerStart(core->timer, period);
+}
+
+IRAM_ATTR static uint32_t timer_stop(Protomatter_core *core) {
+#if defined(_PM_timerMaxCount)
+  return _PM_timerStop(core->timer) << core->timerShift;
+#else
+  return _PM_timerStop(core->timer);
+#endif
+}
+
+// Ticks since the timer was started, from a count read in its interrupt,
+// i.e. once it has reached its period. Most timers here restart from zero
+// on reaching the period (SAMD MFRQ mode, auto-reload) while others count
+// on, so a count short of the period has wrapped. One that wrapped more
+// than once (a handler overrunning by a whole period) still reads short.
+IRAM_ATTR static uint32_t timer_unwrap(Protomatter_core *core,
+                                       uint32_t count) {
+  return (count < core->timerPeriod) ? count + core->timerPeriod : count;
+}
+
+IRAM_ATTR static uint32_t timer_count(Protomatter_core *core) {
+#if defined(_PM_timerMaxCount)
+  return _PM_timerGetCount(core->timer) << core->timerShift;
+#else
+  return _PM_timerGetCount(core->timer);
+#endif
+}
 
+// Choose the finest timer resolution (least prescale) at which the
+// longest plane period still fits the timer's range, e.g. deep bit
+// depths or low refresh rates on a 16-bit timer. Timer must be stopped,
+// as it is when called from the row handler. Shift is only reduced with
+// some headroom, so it doesn't flap as bitZeroPeriod wanders.
+IRAM_ATTR static void fit_timer(Protomatter_core *core) {
+#if defined(_PM_timerMaxCount)
+  uint32_t longest = 0;
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    uint32_t period = plane_period(core, p);
+    if (period > longest) {
+      longest = period;
+    }
+  }
+  uint8_t shift = core->timerShift;
+  while (((longest >> shift) > _PM_timerMaxCount) &&
+         (shift < _PM_timerMaxShift)) {
+    shift++;
+  }
+  while (shift && ((longest >> (shift - 1)) < (_PM_timerMaxCount / 4 * 3))) {
+    shift--;
+  }
+  if (shift != core->timerShift) {
+    _PM_timerPrescale(core->timer, shift);
+    core->timerShift = shift;
+  }
+#else
+  (void)core;
+#endif
+}
+
+// Issue data for the current row & plane to the matrix shift registers.
+IRAM_ATTR static void blast_plane(Protomatter_core *core) {
   uint32_t elementsPerLine =
       _PM_chunkSize * ((core->width + (_PM_chunkSize - 1)) / _PM_chunkSize);
-  uint32_t srcOffset = elementsPerLine *
-                       (core->numPlanes * core->row + core->plane) *
+  uint8_t row = core->row >> core->doubleRows; // Stored row pair
+  uint32_t srcOffset = elementsPerLine * (core->numPlanes * row + core->plane) *
                        core->bytesPerElement;
   if (core->doubleBuffer) {
     srcOffset += core->bufferSize * core->activeBuffer;
@@ -565,8 +1003,6 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   } else {
     blast_long(core, (uint32_t *)(core->screenData + srcOffset));
   }
-
-  // 'plane' data is now loaded, will be shown on NEXT pass
 }
 
 // Innermost data-stuffing loop functions
@@ -579,6 +1015,13 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
 // after data is placed on the PORT. _PM_clockHoldHigh is code for delay
 // before setting the clock back low. If undefined, nothing goes there.
 
+// Direct OUT writes (below) are an alternative to the default no-toggle
+// PEW only; not with a custom PEW, toggle or combined set/clear register.
+#if !defined(PEW) && !defined(_PM_portToggleRegister) &&                       \
+    !defined(_PM_SET_CLEAR_COMBINED)
+#define _PM_DIRECT_OUT ///< OUT register writes are supported
+#endif
+
 #if !defined(PEW) // arch.h can define a custom PEW if needed (e.g. ESP32)
 
 #if !defined(_PM_STRICT_32BIT_IO) // Partial access to 32-bit GPIO OK
@@ -589,6 +1032,14 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   _PM_clockHoldLow;                                                            \
   *toggle = clock; /* Toggle clock high */                                     \
   _PM_clockHoldHigh;
+#define _PM_PEW_WRITES 2 ///< PORT writes per PEW, see _PM_getRowCost()
+#elif defined(_PM_SET_CLEAR_COMBINED)
+#define PEW                                                                    \
+  *set = *data++; /* Set RGB data, clear other RGB bits + clock */             \
+  _PM_clockHoldLow;                                                            \
+  *set_full = clock; /* Set clock high */                                      \
+  _PM_clockHoldHigh;
+#define _PM_PEW_WRITES 2 ///< PORT writes per PEW, see _PM_getRowCost()
 #else
 #define PEW                                                                    \
   *set = *data++; /* Set RGB data high */                                      \
@@ -597,6 +1048,7 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   _PM_clockHoldHigh;                                                           \
   *clear_full = rgbclock; /* Clear RGB data + clock */                         \
   ///< Bitbang one set of RGB data bits to matrix
+#define _PM_PEW_WRITES 3 ///< PORT writes per PEW, see _PM_getRowCost()
 #endif
 
 #else // ONLY 32-bit GPIO
@@ -607,6 +1059,7 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   _PM_clockHoldLow;                                                            \
   *toggle = clock; /* Toggle clock high */                                     \
   _PM_clockHoldHigh;
+#define _PM_PEW_WRITES 2 ///< PORT writes per PEW, see _PM_getRowCost()
 #else
 #define PEW                                                                    \
   *set = *data++ << shift; /* Set RGB data high */                             \
@@ -615,37 +1068,77 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
   _PM_clockHoldHigh;                                                           \
   *clear = rgbclock; /* Clear RGB data + clock */                              \
   ///< Bitbang one set of RGB data bits to matrix
+#define _PM_PEW_WRITES 3 ///< PORT writes per PEW, see _PM_getRowCost()
 #endif
 
 #endif // end 32-bit GPIO
 
 #endif // end PEW
 
+#if !defined(_PM_PEW_WRITES) // Custom PEW from arch.h that doesn't say
+#define _PM_PEW_WRITES 0     ///< Unknown, see _PM_getRowCost()
+#endif
+
+// Optional direct-to-OUT-register variant for ports lacking a toggle
+// register. The RGB+clock bits of PORT are rewritten whole (two writes
+// per column rather than three), ORed with a copy of the other PORT bits
+// read once at the start of the scanline. Only safe if nothing else (a
+// higher-priority interrupt, DMA) changes that PORT while the row handler
+// is running, which can't be determined here, so it's opt-in; see
+// _PM_setDirectOut(). Deferred shifts (_PM_setDeferredShift()) run at
+// task or low-interrupt level, where that can't be guaranteed at all,
+// so direct writes are skipped while one is set.
+#if defined(_PM_DIRECT_OUT)
+#define PEW_DIRECT                                                             \
+  bits = other | ((_PM_PORT_TYPE)*data++ << shift);                            \
+  *out = bits; /* RGB data + clock low */                                      \
+  _PM_clockHoldLow;                                                            \
+  *out = bits | clock; /* Clock high */                                        \
+  _PM_clockHoldHigh;
+#endif
+
 #if _PM_chunkSize == 1
-#define PEW_UNROLL PEW
+#define _PM_UNROLL(x) x
 #elif _PM_chunkSize == 2
-#define PEW_UNROLL PEW PEW ///< 2-way PEW unroll
+#define _PM_UNROLL(x) x x ///< 2-way unroll
 #elif _PM_chunkSize == 4
-#define PEW_UNROLL PEW PEW PEW PEW ///< 4-way PEW unroll
+#define _PM_UNROLL(x) x x x x ///< 4-way unroll
 #elif _PM_chunkSize == 8
-#define PEW_UNROLL PEW PEW PEW PEW PEW PEW PEW PEW ///< 8-way PEW unroll
+#define _PM_UNROLL(x) x x x x x x x x ///< 8-way unroll
 #elif _PM_chunkSize == 16
-#define PEW_UNROLL                                                             \
-  PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW
+#define _PM_UNROLL(x)                                                          \
+  x x x x x x x x x x x x x x x x
 #elif _PM_chunkSize == 32
-#define PEW_UNROLL                                                             \
-  PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW  \
-      PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW
+#define _PM_UNROLL(x)                                                          \
+  x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x
 #elif _PM_chunkSize == 64
-#define PEW_UNROLL                                                             \
-  PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW  \
-      PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW  \
-          PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW  \
-              PEW PEW PEW PEW PEW PEW PEW PEW PEW PEW
+#define _PM_UNROLL(x)                                                          \
+  x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x x    \
+      x x x x x x x x x x x x x x x x x x x x x x x x x x x
 #else
 #error "Unimplemented _PM_chunkSize value"
 #endif
 
+// Column doubling (see _PM_setPixelDoubling()) issues each element twice.
+// Data bits are already on the PORT after a toggle-register PEW, so the
+// repeat is just a clock pulse. Otherwise PEW left the data bits LOW (or
+// it's a custom PEW from arch.h), just issue the same element again.
+#if defined(_PM_portToggleRegister)
+#define PEW_REPEAT                                                             \
+  *toggle = clock; /* Toggle clock low, data unchanged */                      \
+  _PM_clockHoldLow;                                                            \
+  *toggle = clock; /* Toggle clock high */                                     \
+  _PM_clockHoldHigh;
+#else
+#define PEW_REPEAT                                                             \
+  data--; /* Back up to same element */                                        \
+  PEW
+#endif
+
+#define PEW_UNROLL _PM_UNROLL(PEW) ///< _PM_chunkSize-way PEW unroll
+#define PEW_DOUBLE_UNROLL _PM_UNROLL(PEW PEW_REPEAT) ///< Same, doubled
+#define PEW_DIRECT_UNROLL _PM_UNROLL(PEW_DIRECT) ///< Same, OUT register
+
 // There are THREE COPIES of the following function -- one each for byte,
 // word and long. If changes are made in any one of them, the others MUST
 // be updated to match! (Decided against using macro tricks for the
@@ -653,6 +1146,25 @@ IRAM_ATTR void _PM_row_handler(Protomatter_core *core) {
 // three-function maintenance then.)
 
 IRAM_ATTR static void blast_byte(Protomatter_core *core, uint8_t *data) {
+#if defined(_PM_DIRECT_OUT)
+  if (core->directOut && !core->doubleColumns && !core->shiftSignal) {
+    // Two OUT writes per column, see PEW_DIRECT. No-toggle clock and
+    // rgbAndClockMask are always full-PORT values; RGB data in the
+    // buffer is 8-bit here, hence the shift.
+    volatile _PM_PORT_TYPE *out = (volatile _PM_PORT_TYPE *)core->outReg;
+    _PM_PORT_TYPE clock = core->clockMask;
+    _PM_PORT_TYPE other = *out & ~core->rgbAndClockMask; // Non-RGBC bits
+    _PM_PORT_TYPE bits;
+    uint8_t shift = core->portOffset * 8;
+    uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
+    while (chunks--) {
+      PEW_DIRECT_UNROLL // _PM_chunkSize RGB+clock writes
+    }
+    *out = other; // Leave RGB data + clock LOW
+    return;
+  }
+#endif
+
 #if !defined(_PM_STRICT_32BIT_IO) // Partial access to 32-bit GPIO OK
 
 #if defined(_PM_portToggleRegister)
@@ -679,8 +1191,14 @@ IRAM_ATTR static void blast_byte(Protomatter_core *core, uint8_t *data) {
   // PORT has already been initialized with RGB data + clock bits
   // all LOW, so we don't need to initialize that state here.
 
-  while (chunks--) {
-    PEW_UNROLL // _PM_chunkSize RGB+clock writes
+  if (core->doubleColumns) {
+    while (chunks--) {
+      PEW_DOUBLE_UNROLL // _PM_chunkSize * 2 RGB+clock writes
+    }
+  } else {
+    while (chunks--) {
+      PEW_UNROLL // _PM_chunkSize RGB+clock writes
+    }
   }
 
 #if defined(_PM_portToggleRegister)
@@ -691,6 +1209,10 @@ IRAM_ATTR static void blast_byte(Protomatter_core *core, uint8_t *data) {
   // rgbAndClockMask is an 8-bit value when toggling, hence offset here.
   *((volatile uint8_t *)core->clearReg + core->portOffset) =
       core->rgbAndClockMask;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+  // Same for combined set/clear register (and always 32-bit elements
+  // in that case, see begin(), so this is just for consistency).
+  *clear_full = rgbclock;
 #endif
 
 #else // ONLY 32-bit GPIO
@@ -709,8 +1231,14 @@ IRAM_ATTR static void blast_byte(Protomatter_core *core, uint8_t *data) {
   // PORT has already been initialized with RGB data + clock bits
   // all LOW, so we don't need to initialize that state here.
 
-  while (chunks--) {
-    PEW_UNROLL // _PM_chunkSize RGB+clock writes
+  if (core->doubleColumns) {
+    while (chunks--) {
+      PEW_DOUBLE_UNROLL // _PM_chunkSize * 2 RGB+clock writes
+    }
+  } else {
+    while (chunks--) {
+      PEW_UNROLL // _PM_chunkSize RGB+clock writes
+    }
   }
 
 #if defined(_PM_portToggleRegister)
@@ -721,6 +1249,22 @@ IRAM_ATTR static void blast_byte(Protomatter_core *core, uint8_t *data) {
 }
 
 IRAM_ATTR static void blast_word(Protomatter_core *core, uint16_t *data) {
+#if defined(_PM_DIRECT_OUT)
+  if (core->directOut && !core->doubleColumns && !core->shiftSignal) {
+    volatile _PM_PORT_TYPE *out = (volatile _PM_PORT_TYPE *)core->outReg;
+    _PM_PORT_TYPE clock = core->clockMask;
+    _PM_PORT_TYPE other = *out & ~core->rgbAndClockMask; // Non-RGBC bits
+    _PM_PORT_TYPE bits;
+    uint8_t shift = core->portOffset * 16;
+    uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
+    while (chunks--) {
+      PEW_DIRECT_UNROLL // _PM_chunkSize RGB+clock writes
+    }
+    *out = other; // Leave RGB data + clock LOW
+    return;
+  }
+#endif
+
 #if !defined(_PM_STRICT_32BIT_IO) // Partial access to 32-bit GPIO OK
 
 #if defined(_PM_portToggleRegister)
@@ -738,13 +1282,21 @@ IRAM_ATTR static void blast_word(Protomatter_core *core, uint16_t *data) {
 #endif
   _PM_PORT_TYPE clock = core->clockMask; // Clock bit
   uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
-  while (chunks--) {
-    PEW_UNROLL // _PM_chunkSize RGB+clock writes
+  if (core->doubleColumns) {
+    while (chunks--) {
+      PEW_DOUBLE_UNROLL // _PM_chunkSize * 2 RGB+clock writes
+    }
+  } else {
+    while (chunks--) {
+      PEW_UNROLL // _PM_chunkSize RGB+clock writes
+    }
   }
 #if defined(_PM_portToggleRegister)
   // rgbAndClockMask is a 16-bit value when toggling, hence offset here.
   *((volatile uint16_t *)core->clearReg + core->portOffset) =
       core->rgbAndClockMask;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+  *clear_full = rgbclock;
 #endif
 
 #else // ONLY 32-bit GPIO
@@ -759,8 +1311,14 @@ IRAM_ATTR static void blast_word(Protomatter_core *core, uint16_t *data) {
   _PM_PORT_TYPE clock = core->clockMask; // Clock bit
   uint8_t shift = core->portOffset * 16;
   uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
-  while (chunks--) {
-    PEW_UNROLL // _PM_chunkSize RGB+clock writes
+  if (core->doubleColumns) {
+    while (chunks--) {
+      PEW_DOUBLE_UNROLL // _PM_chunkSize * 2 RGB+clock writes
+    }
+  } else {
+    while (chunks--) {
+      PEW_UNROLL // _PM_chunkSize RGB+clock writes
+    }
   }
 #if defined(_PM_portToggleRegister)
   *((volatile _PM_PORT_TYPE *)core->clearReg) = core->rgbAndClockMask;
@@ -770,6 +1328,22 @@ IRAM_ATTR static void blast_word(Protomatter_core *core, uint16_t *data) {
 }
 
 IRAM_ATTR static void blast_long(Protomatter_core *core, uint32_t *data) {
+#if defined(_PM_DIRECT_OUT)
+  if (core->directOut && !core->doubleColumns && !core->shiftSignal) {
+    volatile _PM_PORT_TYPE *out = (volatile _PM_PORT_TYPE *)core->outReg;
+    _PM_PORT_TYPE clock = core->clockMask;
+    _PM_PORT_TYPE other = *out & ~core->rgbAndClockMask; // Non-RGBC bits
+    _PM_PORT_TYPE bits;
+    uint8_t shift = 0;
+    uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
+    while (chunks--) {
+      PEW_DIRECT_UNROLL // _PM_chunkSize RGB+clock writes
+    }
+    *out = other; // Leave RGB data + clock LOW
+    return;
+  }
+#endif
+
 #if defined(_PM_portToggleRegister)
   // See notes above -- except now full 32-bit PORT.
   volatile uint32_t *toggle = (volatile uint32_t *)core->toggleReg;
@@ -790,14 +1364,135 @@ IRAM_ATTR static void blast_long(Protomatter_core *core, uint32_t *data) {
   uint8_t shift = 0;
 #endif
   uint8_t chunks = (core->width + (_PM_chunkSize - 1)) / _PM_chunkSize;
-  while (chunks--) {
-    PEW_UNROLL // _PM_chunkSize RGB+clock writes
+  if (core->doubleColumns) {
+    while (chunks--) {
+      PEW_DOUBLE_UNROLL // _PM_chunkSize * 2 RGB+clock writes
+    }
+  } else {
+    while (chunks--) {
+      PEW_UNROLL // _PM_chunkSize RGB+clock writes
+    }
   }
 #if defined(_PM_portToggleRegister)
   *(volatile uint32_t *)core->clearReg = core->rgbAndClockMask;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+  *clear_full = rgbclock; // PEW leaves last data + clock set, as w/toggle
 #endif
 }
 
+// Set relative display time of each bitplane. Values are in any units,
+// normalized here to 8.8 fixed-point multiples of plane 0's period
+// (which the row handler measures and adapts to). Binary weighting
+// (1, 2, 4, ...) is the default following _PM_begin().
+ProtomatterStatus _PM_setPlaneWeights(Protomatter_core *core,
+                                      const uint16_t *weights) {
+  if (!core || !core->screenData || !weights || !weights[0]) {
+    return PROTOMATTER_ERR_ARG;
+  }
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    uint32_t w = ((uint32_t)weights[p] << 8) / weights[0];
+    core->planeWeight[p] = (w < 1) ? 1 : (w > 65535) ? 65535 : w;
+  }
+  set_min_period(core);
+  return PROTOMATTER_OK;
+}
+
+// Request 32-bit matrix elements (PORT-aligned, no shift needed when
+// issuing data) even if RGB pins would fit in a byte or word. Must be
+// called after _PM_init() and before _PM_begin() to have any effect.
+void _PM_setLongElements(Protomatter_core *core, bool enable) {
+  if ((core) && !core->screenData) {
+    core->longElements = enable;
+  }
+}
+
+// Enable or disable whole-PORT writes to the OUT register when issuing
+// RGB data (see PEW_DIRECT above). Can be changed at any time; takes
+// effect on the next scanline. Returns true if direct mode is now in use,
+// false if disabled or unsupported on this device.
+bool _PM_setDirectOut(Protomatter_core *core, bool enable) {
+  if ((core)) {
+#if defined(_PM_DIRECT_OUT)
+    core->directOut = enable;
+#else
+    (void)enable;
+    core->directOut = 0;
+#endif
+    return core->directOut && !core->shiftSignal;
+  }
+  return false;
+}
+
+// Canvas regions updated independently, see _PM_regionShow() in arch.h.
+// Each region counts commits (producer side) and the count it last showed
+// (_PM_regionShow() side), so neither writes the other's value and a
+// commit made mid-conversion isn't lost.
+int8_t _PM_regionAdd(Protomatter_core *core, int16_t x, int16_t y, int16_t w,
+                     int16_t h) {
+  if (!core || (core->numRegions >= _PM_MAX_REGIONS)) {
+    return -1;
+  }
+  _PM_region *r = &core->regions[core->numRegions];
+  r->x = x;
+  r->y = y;
+  r->w = w;
+  r->h = h;
+  core->regionCommits[core->numRegions] = 0;
+  core->regionShown[core->numRegions] = 0;
+  return core->numRegions++;
+}
+
+void _PM_regionCommit(Protomatter_core *core, uint8_t region) {
+  if (core && (region < core->numRegions)) {
+    core->regionCommits[region]++; // Only this region's producer writes
+  }
+}
+
+bool _PM_regionPending(Protomatter_core *core, uint8_t region) {
+  return core && (region < core->numRegions) &&
+         (core->regionCommits[region] != core->regionShown[region]);
+}
+
+void _PM_regionClear(Protomatter_core *core) {
+  if (core) {
+    core->numRegions = 0;
+    for (uint8_t r = 0; r < _PM_MAX_REGIONS; r++) {
+      core->regionCommits[r] = core->regionShown[r] = 0;
+    }
+  }
+}
+
+// Set panel-specific timing. Can be changed at any time (e.g. to tune
+// while watching the matrix), takes effect on the next row.
+void _PM_setPanelProfile(Protomatter_core *core,
+                         const _PM_panelProfile *profile) {
+  if (core && profile) {
+    core->rowDelay = profile->rowDelay;
+    core->oeDelay = profile->oeDelay;
+  }
+}
+
+// Display each stored pixel as 2 columns and/or 2 rows of LEDs, for low-
+// resolution content on a bigger matrix: the matrix buffer (and time spent
+// converting to it) is then 1/2 or 1/4 the size. Stored width becomes half
+// the chain width; the row handler repeats each stored element in the
+// blast functions, and sends stored row pair r/2 to physical row pair r.
+// Content pixel rows map to pins the same as an undoubled matrix of half
+// the height. Must be called after _PM_init() and before _PM_begin().
+bool _PM_setPixelDoubling(Protomatter_core *core, bool columns, bool rows) {
+  if (!core || core->screenData) {
+    return false;
+  }
+  uint16_t width = core->width << core->doubleColumns; // Physical width
+  if ((columns && (width & 1)) || (rows && !core->numAddressLines)) {
+    return false; // Odd chain width, or just one row pair
+  }
+  core->doubleColumns = columns;
+  core->doubleRows = rows;
+  core->width = width >> columns;
+  return true;
+}
+
 // Returns current value of frame counter and resets its value to zero.
 // Two calls to this, timed one second apart (or use math with other
 // intervals), can be used to get a rough frames-per-second value for
@@ -811,6 +1506,624 @@ uint32_t _PM_getFrameCount(Protomatter_core *core) {
   return count;
 }
 
+// Move data shifting out of the timer interrupt, see _PM_row_shift().
+void _PM_setDeferredShift(Protomatter_core *core, void (*signal)(void)) {
+  if ((core)) {
+    if (!signal) {
+      _PM_row_shift(core); // Don't leave a plane pending
+    }
+    core->shiftSignal = signal;
+  }
+}
+
+// Handle very short planes within one row handler call, see row_step().
+void _PM_setCoalescing(Protomatter_core *core, bool enable) {
+  if ((core)) {
+    core->coalesce = enable;
+  }
+}
+
+// Skip unchanged rows in _PM_convert_565(), see changed_rows() in arch.h.
+void _PM_setRowHashing(Protomatter_core *core, bool enable) {
+  if ((core)) {
+    core->rowHashing = enable;
+    core->hashValid = 0; // Not kept up while off
+  }
+}
+
+uint32_t _PM_getLateShifts(Protomatter_core *core) {
+  uint32_t count = 0;
+  if ((core)) {
+    count = core->lateShifts;
+    core->lateShifts = 0;
+  }
+  return count;
+}
+
+// Frame pacing: hold each double-buffered frame for a fixed number of
+// matrix refreshes (see row handler), so animation doesn't judder as the
+// refresh rate floats. The starting count is estimated from the current
+// plane periods, which may still be the initial guess if the matrix was
+// only just started; pace_frames() corrects it from measured refreshes.
+uint8_t _PM_setFrameRate(Protomatter_core *core, uint16_t fps) {
+  if (!core || !core->screenData || !core->doubleBuffer || !fps) {
+    if (core) {
+      core->targetFps = 0;
+      core->swapInterval = 0;
+    }
+    return 0;
+  }
+  uint32_t ticks = 0; // Timer ticks per row pair
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    ticks += plane_period(core, p);
+  }
+  ticks *= core->numRowPairs << core->doubleRows;
+  uint32_t refreshHz = ticks ? (_PM_timerFreq / ticks) : 1;
+  uint32_t interval = (refreshHz + fps / 2) / fps;
+  core->swapInterval = (interval < 1) ? 1 : (interval > 255) ? 255 : interval;
+  core->dropped = core->duplicated = 0;
+  core->refreshTicks = 0; // Start measurements over
+  core->targetFps = fps;
+  return core->swapInterval;
+}
+
+void _PM_getFrameStats(Protomatter_core *core, uint32_t *dropped,
+                       uint32_t *duplicated) {
+  if ((core)) {
+    // Read and reset each; the row handler may bump them in between,
+    // which is fine for statistics.
+    if (dropped) {
+      *dropped = core->dropped;
+    }
+    core->dropped = 0;
+    if (duplicated) {
+      *duplicated = core->duplicated;
+    }
+    core->duplicated = 0;
+  }
+}
+
+// Report measured versus requested display time of each bitplane, as
+// recorded by the row handler. ISR latency and the minPeriod clamp mostly
+// stretch the lowest planes, throwing off the ratios between planes
+// (visible as color shifts in dark tones).
+uint8_t _PM_getPlaneTiming(Protomatter_core *core, _PM_planeTiming *timing) {
+  if (!core || !core->screenData || !timing) {
+    return 0;
+  }
+  uint32_t prior = 0;
+  for (uint8_t p = 0; p < core->numPlanes; p++) {
+    uint32_t ticks = core->planeTicks[p];
+    uint32_t target = plane_period(core, p);
+    timing[p].ticks = ticks;
+    timing[p].target = target;
+    if (p) {
+      // A long interrupt stall can leave one plane's ticks many times
+      // its neighbor's (or target's), so these are worked out in 64 bits
+      // and clipped to fit.
+      uint64_t ratio = prior ? ((uint64_t)ticks << 8) / prior : 0;
+      timing[p].ratio = (ratio > 0xFFFF) ? 0xFFFF : ratio;
+      timing[p].idealRatio =
+          ((uint32_t)core->planeWeight[p] << 8) / core->planeWeight[p - 1];
+    } else {
+      timing[p].ratio = timing[p].idealRatio = 256;
+    }
+    int64_t error =
+        target ? ((int64_t)ticks - (int64_t)target) * 1000 / target : 0;
+    timing[p].error = (error > INT32_MAX) ? INT32_MAX : error;
+    prior = ticks;
+  }
+  return core->numPlanes;
+}
+
+// Report the row handler's cost for benchmarking. PORT writes per column
+// are fixed by the PEW variant compiled in (column doubling issues each
+// element twice but changes nothing per column), or two for direct OUT
+// writes when those are actually in use.
+bool _PM_getRowCost(Protomatter_core *core, _PM_rowCost *cost) {
+  if (!core || !core->screenData || !cost) {
+    return false;
+  }
+  cost->timerFreq = _PM_timerFreq;
+  cost->entryTicks = core->entryEighths / 8;
+  cost->shiftTicks = core->shiftTicks;
+  cost->portWrites = _PM_PEW_WRITES;
+#if defined(_PM_DIRECT_OUT)
+  if (core->directOut && !core->doubleColumns && !core->shiftSignal) {
+    cost->portWrites = 2;
+  }
+#endif
+  cost->elementBytes = core->bytesPerElement;
+  return true;
+}
+
+// Block until the next frame has been issued to the matrix, e.g. to pace
+// animation to the refresh rate. Uses the _PM_vblankWait() arch hook, so
+// on an RTOS other tasks get the CPU in the meantime rather than spinning.
+// Returns right away if refresh is paused or stopped (or stops meanwhile),
+// as no frame would ever come.
+void _PM_waitVblank(Protomatter_core *core) {
+  if ((core) && core->screenData) {
+    uint32_t count = core->vblankCount;
+    while ((core->vblankCount == count) && !core->paused && core->running) {
+      if (!_PM_vblankWait(core)) {
+        break; // Arch says the row handler can't run
+      }
+    }
+  }
+}
+
+// EDITING MATRIX DATA IN PLACE --------------------------------------------
+
+// Most changes to the display go through a full conversion from some
+// canvas (see arch.h), but small changes -- scrolling, updating one region
+// -- can be made directly to the matrix buffer much faster. Elements may
+// be toggle- or set/clear-encoded depending on the device though, and with
+// single buffering that buffer is on the matrix, so nothing is decoded in
+// place: _PM_editSeek() positions a cursor in one plane line, carrying
+// the plain RGB bits (one per RGB pin, see rgbMask) of the element before
+// it, so _PM_editNext() can re-encode each element as it's changed and
+// _PM_editClose() fixes up the one after (a toggle-encoded element holds
+// the change from its predecessor).
+
+// Element access for any bytesPerElement. Not used in the row handler,
+// just editing functions, so a switch on size is fine here.
+static uint32_t get_element(Protomatter_core *core, void *buf, uint32_t i) {
+  if (core->bytesPerElement == 1) {
+    return ((uint8_t *)buf)[i];
+  } else if (core->bytesPerElement == 2) {
+    return ((uint16_t *)buf)[i];
+  }
+  return ((uint32_t *)buf)[i];
+}
+
+static void put_element(Protomatter_core *core, void *buf, uint32_t i,
+                        uint32_t value) {
+  if (core->bytesPerElement == 1) {
+    ((uint8_t *)buf)[i] = value;
+  } else if (core->bytesPerElement == 2) {
+    ((uint16_t *)buf)[i] = value;
+  } else {
+    ((uint32_t *)buf)[i] = value;
+  }
+}
+
+// Returns the buffer that conversion functions and editing should write
+// to: the one NOT being displayed if double-buffered, else the only one.
+// If the display has been swapped since that buffer was last fully
+// converted, it holds an older frame; bring it up to date first so
+// partial edits apply to what's actually on the matrix. Edits mean the
+// canvas row hashes (see _PM_convert_565()) no longer apply.
+static uint8_t *edit_buffer(Protomatter_core *core) {
+  core->hashValid = 0;
+  uint8_t *buf = (uint8_t *)core->screenData;
+  if (core->doubleBuffer) {
+    uint8_t *front = buf + core->bufferSize * core->activeBuffer;
+    buf += core->bufferSize * (1 - core->activeBuffer);
+    if (core->staleBack) {
+      memcpy(buf, front, core->bufferSize);
+      core->staleBack = 0;
+    }
+  }
+  return buf;
+}
+
+void *_PM_editBuffer(Protomatter_core *core) {
+  return (core && core->screenData) ? edit_buffer(core) : NULL;
+}
+
+void _PM_editSeek(Protomatter_core *core, _PM_editCursor *ed, void *buf,
+                  uint8_t row, uint8_t plane, int16_t x) {
+  uint32_t elementsPerLine =
+      _PM_chunkSize * ((core->width + (_PM_chunkSize - 1)) / _PM_chunkSize);
+  ed->line = (uint8_t *)buf + (row * core->numPlanes + plane) *
+                                  elementsPerLine * core->bytesPerElement;
+  ed->i = elementsPerLine - core->width + x;
+  ed->end = elementsPerLine;
+  ed->was = 0;
+#if defined(_PM_portToggleRegister)
+  // Clock bit as stored in elements (8- or 16-bit value if byte or word)
+  ed->clk = _PM_portBitMask(core->clockPin) >>
+            (core->portOffset * 8 * core->bytesPerElement);
+  // First element of line is plain, each subsequent one toggles from the
+  // prior (plus clock), so the plain bits of element i-1 are the running
+  // XOR of everything up to it, less clock.
+  for (uint32_t i = 0; i < ed->i; i++) {
+    ed->was ^= get_element(core, ed->line, i) & ~ed->clk;
+  }
+#else
+  ed->clk = 0;
+#endif
+  ed->now = ed->was;
+}
+
+uint32_t _PM_editNext(Protomatter_core *core, _PM_editCursor *ed,
+                      uint32_t mask, uint32_t bits) {
+  uint32_t e = get_element(core, ed->line, ed->i);
+#if defined(_PM_portToggleRegister)
+  uint32_t was = ed->was ^ (e & ~ed->clk);
+  uint32_t now = (was & ~mask) | bits;
+  // Element is the change from its predecessor; that changes if either
+  // this element's bits or the predecessor's did. Clock is unaffected.
+  uint32_t delta = (now ^ was) ^ (ed->now ^ ed->was);
+  ed->was = was;
+  ed->now = now;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+  uint32_t was = e & 0xFFFF; // Set bits in lower half, clear bits upper
+  uint32_t now = (was & ~mask) | bits;
+  uint32_t delta = (now ^ was) | ((now ^ was) << 16);
+#else
+  uint32_t was = e;
+  uint32_t now = (was & ~mask) | bits;
+  uint32_t delta = now ^ was;
+#endif
+  if (delta) {
+    put_element(core, ed->line, ed->i, e ^ delta);
+  }
+  ed->i++;
+  return was;
+}
+
+void _PM_editClose(Protomatter_core *core, _PM_editCursor *ed) {
+#if defined(_PM_portToggleRegister)
+  if ((ed->i < ed->end) && (ed->was != ed->now)) {
+    put_element(core, ed->line, ed->i,
+                get_element(core, ed->line, ed->i) ^ ed->was ^ ed->now);
+  }
+  ed->was = ed->now;
+#else
+  (void)core;
+  (void)ed;
+#endif
+}
+
+// Encoding of an element with the given plain RGB bits at index i of a
+// plane line, following one with plain bits 'prior' (toggle encoding
+// only; the first element of a line has no predecessor, and no clock).
+static uint32_t encode_element(Protomatter_core *core, uint32_t clk,
+                               uint32_t i, uint32_t now, uint32_t prior) {
+#if defined(_PM_portToggleRegister)
+  (void)core;
+  return i ? ((now ^ prior) | clk) : now;
+#elif defined(_PM_SET_CLEAR_COMBINED)
+  (void)clk;
+  (void)i;
+  (void)prior;
+  return now | ((core->rgbAndClockMask & ~now) << 16);
+#else
+  (void)core;
+  (void)clk;
+  (void)i;
+  (void)prior;
+  return now;
+#endif
+}
+
+// Horizontal shift of a whole plane line's pixels x to x+w-1 by dx (the
+// rectangle spans every pixel row sharing the line). The encoded elements
+// themselves move; with toggle encoding each holds the change from its
+// predecessor, which is the same after moving, except where moved and
+// vacated pixels meet, at x, and for the element after the rectangle.
+// Just those are re-encoded, from plain bits read on the way in.
+static void scroll_line(Protomatter_core *core, uint8_t *buf, uint8_t row,
+                        uint8_t plane, int16_t x, int16_t w, int16_t dx) {
+  // n elements move from 'from' to 'to', w-n at 'vacant' are cleared
+  int16_t n = w - ((dx > 0) ? dx : -dx);
+  if (n < 0) {
+    n = 0;
+  }
+  int16_t from = (dx > 0) ? x : (x + w - n);
+  int16_t to = (dx > 0) ? (x + w - n) : x;
+  int16_t vacant = (dx > 0) ? x : (x + n);
+  _PM_editCursor ed;
+  _PM_editSeek(core, &ed, buf, row, plane, x);
+  uint32_t before = ed.was, tail = 0; // Plain bits at x-1, from+n-1
+#if defined(_PM_portToggleRegister)
+  uint32_t head = 0; // Plain bits at from
+  for (int16_t i = x; i < x + w; i++) {
+    uint32_t bits = _PM_editNext(core, &ed, 0, 0);
+    if (i == from) {
+      head = bits;
+    }
+    if (i == from + n - 1) {
+      tail = bits;
+    }
+  }
+#endif
+  uint32_t pad = ed.end - core->width;
+  uint8_t bpe = core->bytesPerElement;
+  uint8_t *line = (uint8_t *)ed.line;
+  memmove(line + (pad + to) * bpe, line + (pad + from) * bpe, n * bpe);
+  for (int16_t i = vacant; i < vacant + w - n; i++) {
+    uint32_t prior = (i != vacant) ? 0 : (i == x) ? before : tail;
+    put_element(core, line, pad + i,
+                encode_element(core, ed.clk, pad + i, 0, prior));
+  }
+#if defined(_PM_portToggleRegister)
+  if (n) {
+    put_element(core, line, pad + to,
+                encode_element(core, ed.clk, pad + to, head,
+                               (to == x) ? before : 0));
+  }
+  ed.now = (n && (dx > 0)) ? tail : 0; // New bits at x+w-1
+  _PM_editClose(core, &ed);
+#endif
+}
+
+#define SCROLL_CHUNK 32 ///< Pixels moved per pass in scroll_row()
+
+// Any other move, one matrix pixel row yd and plane at a time: pixels in
+// x to x+w-1 come from row ys (or are cleared if ys is outside the
+// rectangle), dx to the left. Pixels are moved in chunks, each read (and
+// decoded) into a small local array, then written back re-encoded; chunks
+// go from the side pixels are moving toward, so sources are read before
+// being overwritten (like memmove). Between rows, this means moving bits
+// between RGB pins (upper/lower half, chains) using the pin masks.
+static void scroll_row(Protomatter_core *core, uint8_t *buf, uint8_t plane,
+                       int16_t x, int16_t w, int16_t dx, int16_t yd,
+                       int16_t ys, bool inside) {
+  uint8_t dRow = yd % core->numRowPairs, sRow = ys % core->numRowPairs;
+  uint8_t dPin = (yd / core->numRowPairs) * 3;
+  uint8_t sPin = (ys / core->numRowPairs) * 3;
+  uint32_t dMask[3], sMask[3];
+  for (uint8_t k = 0; k < 3; k++) {
+    dMask[k] = get_element(core, core->rgbMask, dPin + k);
+    sMask[k] = get_element(core, core->rgbMask, sPin + k);
+  }
+  uint32_t dAll = dMask[0] | dMask[1] | dMask[2];
+  uint32_t plain[SCROLL_CHUNK];
+  _PM_editCursor ed;
+  for (int16_t done = 0; done < w; done += SCROLL_CHUNK) {
+    int16_t n = (w - done < SCROLL_CHUNK) ? (w - done) : SCROLL_CHUNK;
+    int16_t xd = (dx > 0) ? (x + w - done - n) : (x + done);
+    memset(plain, 0, n * sizeof plain[0]);
+    // Source columns xd-dx on, within the rectangle
+    int16_t lo = xd - dx, hi = lo + n;
+    lo = (lo < x) ? x : lo;
+    hi = (hi > x + w) ? (x + w) : hi;
+    if (inside && (lo < hi)) {
+      _PM_editSeek(core, &ed, buf, sRow, plane, lo);
+      for (int16_t xs = lo; xs < hi; xs++) {
+        uint32_t src = _PM_editNext(core, &ed, 0, 0);
+        for (uint8_t k = 0; k < 3; k++) {
+          if (src & sMask[k]) {
+            plain[xs + dx - xd] |= dMask[k];
+          }
+        }
+      }
+    }
+    _PM_editSeek(core, &ed, buf, dRow, plane, xd);
+    for (int16_t i = 0; i < n; i++) {
+      (void)_PM_editNext(core, &ed, dAll, plain[i]);
+    }
+    _PM_editClose(core, &ed);
+  }
+}
+
+// Shift a rectangle of matrix pixels by dx, dy (positive = right, down),
+// directly in the matrix buffer. Pixels moving in from outside the
+// rectangle are cleared (black); the caller is expected to fill that
+// strip in, e.g. with _PM_convert_565_rect(). Horizontal-only moves
+// (tickers) don't change which RGB pin a pixel uses, so when the
+// rectangle spans every pixel row sharing a plane line, encoded elements
+// just slide along (scroll_line()). Anything else goes through
+// scroll_row(), which decodes a chunk at a time into a local array.
+void _PM_scroll(Protomatter_core *core, int16_t x, int16_t y, int16_t w,
+                int16_t h, int16_t dx, int16_t dy) {
+  if (!core || !core->screenData) {
+    return;
+  }
+  int16_t height = core->numRowPairs * 2 * core->parallel;
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > core->width) {
+    w = core->width - x;
+  }
+  if (y + h > height) {
+    h = height - y;
+  }
+  if ((w <= 0) || (h <= 0) || (!dx && !dy)) {
+    return;
+  }
+
+  uint8_t *buf = edit_buffer(core);
+
+  if (!dy) {
+    // Horizontal only. Gather the RGB bits of the rows being moved in
+    // each row pair; a line can slide as a whole if that's all of them.
+    uint32_t rowBits[32], all = 0;
+    memset(rowBits, 0, sizeof rowBits);
+    for (int16_t yy = y; yy < y + h; yy++) {
+      uint8_t pin = (yy / core->numRowPairs) * 3;
+      for (uint8_t k = 0; k < 3; k++) {
+        rowBits[yy % core->numRowPairs] |=
+            get_element(core, core->rgbMask, pin + k);
+      }
+    }
+    for (uint8_t k = 0; k < core->parallel * 6; k++) {
+      all |= get_element(core, core->rgbMask, k);
+    }
+    for (uint8_t row = 0; (row < core->numRowPairs) && (row < h); row++) {
+      if (rowBits[(y + row) % core->numRowPairs] != all) {
+        for (int16_t yy = y + row; yy < y + h; yy += core->numRowPairs) {
+          for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+            scroll_row(core, buf, plane, x, w, dx, yy, yy, true);
+          }
+        }
+      } else {
+        for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+          scroll_line(core, buf, (y + row) % core->numRowPairs, plane, x, w,
+                      dx);
+        }
+      }
+    }
+    return;
+  }
+
+  for (int16_t j = 0; j < h; j++) {
+    int16_t yd = (dy > 0) ? (y + h - 1 - j) : (y + j); // Dest row
+    int16_t ys = yd - dy;                              // Source row
+    bool inside = (ys >= y) && (ys < y + h);
+    for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+      scroll_row(core, buf, plane, x, w, dx, yd, inside ? ys : yd, inside);
+    }
+  }
+}
+
+// Indexed-color images (e.g. from a GIF decoder) can skip the 565 canvas
+// and full conversion entirely. Each palette entry is expanded once per
+// frame to PORT bits for each bitplane, for every pin group (upper/lower
+// half, chains) at once: bits are set on all RGB pins the color lights in
+// any row. A pixel's bits are then a table lookup per plane, masked to
+// the pins of its row, written straight into the encoded matrix data
+// through the edit cursor.
+
+#define PALETTE_MAX 256 ///< Max palette entries (uint8_t indices)
+
+ProtomatterStatus _PM_paletteBegin(Protomatter_core *core,
+                                   const uint16_t *palette, uint16_t count) {
+  if (!core || !core->screenData || !palette || !count) {
+    return PROTOMATTER_ERR_ARG;
+  }
+  if (count > PALETTE_MAX) {
+    count = PALETTE_MAX;
+  }
+  if (!core->paletteBits) {
+    // Sized for the largest palette so it's allocated just once
+    if (!(core->paletteBits = _PM_ALLOCATOR(
+              PALETTE_MAX * core->numPlanes * core->bytesPerElement))) {
+      return PROTOMATTER_ERR_MALLOC;
+    }
+  }
+
+  // PORT bits of each color component, across all pin groups
+  uint32_t component[3] = {0, 0, 0};
+  for (uint8_t pin = 0; pin < core->parallel * 6; pin++) {
+    component[pin % 3] |= get_element(core, core->rgbMask, pin);
+  }
+
+  // Same 565 bit progression as the conversion functions in arch.h
+  uint16_t initialRedBit, initialGreenBit, initialBlueBit;
+  if (core->numPlanes == 6) {
+    initialRedBit = 0b1000000000000000;   // MSB red
+    initialGreenBit = 0b0000000000100000; // LSB green
+    initialBlueBit = 0b0000000000010000;  // MSB blue
+  } else {
+    uint8_t shiftLeft = 5 - core->numPlanes;
+    initialRedBit = 0b0000100000000000 << shiftLeft;
+    initialGreenBit = 0b0000000001000000 << shiftLeft;
+    initialBlueBit = 0b0000000000000001 << shiftLeft;
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t color = palette[i];
+    uint16_t redBit = initialRedBit;
+    uint16_t greenBit = initialGreenBit;
+    uint16_t blueBit = initialBlueBit;
+    for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+      put_element(core, core->paletteBits, plane * PALETTE_MAX + i,
+                  ((color & redBit) ? component[0] : 0) |
+                      ((color & greenBit) ? component[1] : 0) |
+                      ((color & blueBit) ? component[2] : 0));
+      greenBit <<= 1;
+      if (plane || (core->numPlanes < 6)) {
+        redBit <<= 1;
+        blueBit <<= 1;
+      } else {
+        redBit = 0b0000100000000000;
+        blueBit = 0b0000000000000001;
+      }
+    }
+  }
+  core->paletteSize = count;
+  return PROTOMATTER_OK;
+}
+
+void _PM_paletteLine(Protomatter_core *core, int16_t x, int16_t y,
+                     const uint8_t *indices, uint16_t w) {
+  if (!core || !core->paletteSize || !indices) {
+    return; // Not started, or not between _PM_paletteBegin() and End()
+  }
+  int32_t n = w;
+  if (x < 0) {
+    indices -= x;
+    n += x;
+    x = 0;
+  }
+  if (x + n > core->width) {
+    n = core->width - x;
+  }
+  if ((n <= 0) || (y < 0) || (y >= core->numRowPairs * 2 * core->parallel)) {
+    return;
+  }
+
+  uint8_t *buf = edit_buffer(core);
+  uint8_t row = y % core->numRowPairs;
+  uint8_t pin = (y / core->numRowPairs) * 3;
+  uint32_t mask = 0; // This row's RGB pins
+  for (uint8_t k = 0; k < 3; k++) {
+    mask |= get_element(core, core->rgbMask, pin + k);
+  }
+
+  _PM_editCursor ed;
+  for (uint8_t plane = 0; plane < core->numPlanes; plane++) {
+    uint32_t p = plane * PALETTE_MAX;
+    _PM_editSeek(core, &ed, buf, row, plane, x);
+    for (int32_t j = 0; j < n; j++) {
+      uint8_t idx = indices[j];
+      if (idx < core->paletteSize) {
+        uint32_t bits = get_element(core, core->paletteBits, p + idx);
+        (void)_PM_editNext(core, &ed, mask, bits & mask);
+      } else {
+        (void)_PM_editNext(core, &ed, 0, 0); // Left as-is, step over
+      }
+    }
+    _PM_editClose(core, &ed);
+  }
+}
+
+void _PM_paletteEnd(Protomatter_core *core) {
+  if (core) {
+    core->paletteSize = 0; // Further lines are ignored until next begin
+  }
+}
+
+// Pre-encoded frames (e.g. sliced and encoded by a video wall controller
+// for each board's geometry and pins) are copied straight into the matrix
+// buffer, no conversion at all. Payloads can arrive in chunks; a partial
+// update is applied over the current image like any other edit.
+
+uint32_t _PM_payloadSize(Protomatter_core *core) {
+  return (core && core->screenData) ? core->bufferSize : 0;
+}
+
+ProtomatterStatus _PM_loadPayload(Protomatter_core *core, const void *data,
+                                  uint32_t offset, uint32_t length) {
+  if (!core || !core->screenData || !data ||
+      (offset + length > core->bufferSize) || (offset + length < offset)) {
+    return PROTOMATTER_ERR_ARG;
+  }
+  uint8_t *buf;
+  if (length == core->bufferSize) {
+    // Whole frame, no need to bring the back buffer up to date first
+    buf = (uint8_t *)core->screenData;
+    if (core->doubleBuffer) {
+      buf += core->bufferSize * (1 - core->activeBuffer);
+    }
+    core->staleBack = 0;
+    core->hashValid = 0;
+  } else {
+    buf = edit_buffer(core);
+  }
+  memcpy(buf + offset, data, length);
+  return PROTOMATTER_OK;
+}
+
 // Note to future self: I've gone back and forth between implementing all
 // this either as it currently is (with byte, word and long cases for various
 // steps), or using a uint32_t[64] table for expanding RGB bit combos to PORT
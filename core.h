@@ -45,6 +45,61 @@ typedef struct {
   uint8_t pin;             ///< Some unique ID, e.g. Arduino pin #
 } _PM_pin;
 
+/** Struct for a single pixel change passed to _PM_convert_565_xor(). */
+typedef struct {
+  int16_t x;      ///< Pixel column
+  int16_t y;      ///< Pixel row
+  uint16_t color; ///< 565 color delta (old color XOR new color)
+} _PM_pixel;
+
+/** Position within one bitplane line of the matrix buffer while writing
+    it directly, see _PM_editSeek(). */
+typedef struct {
+  void *line;   ///< Start of line (element 0, padding included)
+  uint32_t i;   ///< Index of next element within line
+  uint32_t end; ///< Elements per line
+  uint32_t was; ///< Plain RGB bits of element i-1 before any change
+  uint32_t now; ///< Plain RGB bits of element i-1 as written
+  uint32_t clk; ///< Clock bit as stored in elements (toggle encoding)
+} _PM_editCursor;
+
+/** Struct for one bitplane's measured timing, see _PM_getPlaneTiming(). */
+typedef struct {
+  uint32_t ticks;      ///< Measured display time, timer ticks (filtered)
+  uint32_t target;     ///< Requested display time, timer ticks
+  uint16_t ratio;      ///< Measured ticks / prior plane's, 8.8 (saturates)
+  uint16_t idealRatio; ///< Requested ratio (512 = 2:1 for binary weights)
+  int32_t error;       ///< ticks vs. target, in 1/1000 (+ = too long)
+} _PM_planeTiming;
+
+/** Struct for the row handler's cost, see _PM_getRowCost(). */
+typedef struct {
+  uint32_t timerFreq;   ///< Timer ticks per second, for the values below
+  uint32_t entryTicks;  ///< Interrupt entry latency (0 = not measured)
+  uint32_t shiftTicks;  ///< Timer start to row data out (0 = not measured)
+  uint8_t portWrites;   ///< PORT writes per column (0 = unknown)
+  uint8_t elementBytes; ///< Bytes per column per bitplane (1, 2 or 4)
+} _PM_rowCost;
+
+#define _PM_MAX_REGIONS 8 ///< Canvas regions, see _PM_regionAdd()
+
+/** Rectangle of the canvas updated on its own, see _PM_regionAdd(). */
+typedef struct {
+  int16_t x; ///< Left edge, in pixels
+  int16_t y; ///< Top edge, in pixels
+  int16_t w; ///< Width, in pixels
+  int16_t h; ///< Height, in pixels
+} _PM_region;
+
+/** Panel-specific timing, see _PM_setPanelProfile(). */
+typedef struct {
+  uint16_t rowDelay; ///< Microseconds to settle after address line change
+  uint8_t oeDelay;   ///< Microseconds from latch to enabling output
+} _PM_panelProfile;
+
+extern const _PM_panelProfile _PM_panelDefault; ///< Slow panels (8 us)
+extern const _PM_panelProfile _PM_panelFast;    ///< No address settle
+
 /** Struct with info about an RGB matrix chain and lots of state and buffer
     details for the library. Toggle-related items in this structure MUST be
     declared even if the device lacks GPIO bit-toggle registers (i.e. don't
@@ -60,34 +115,79 @@ typedef struct {
   void *setReg;                  ///< RGBC bit set register (cast to use)
   void *clearReg;                ///< RGBC bit clear register "
   void *toggleReg;               ///< RGBC bit toggle register "
+  void *outReg;                  ///< RGBC PORT output register "
+  void *dirSetReg;               ///< RGBC direction set reg, or NULL
   uint8_t *rgbPins;              ///< Array of RGB data pins (mult of 6)
   void *rgbMask;                 ///< PORT bit mask for each RGB pin
   uint32_t clockMask;            ///< PORT bit mask for RGB clock
   uint32_t rgbAndClockMask;      ///< PORT bit mask for RGB data + clock
   volatile void *addrPortToggle; ///< See singleAddrPort below
   void *screenData;              ///< Per-bitplane RGB data for matrix
+  uint16_t *planeWeight;         ///< Plane periods, 8.8 rel. to plane 0
+  uint32_t *planeTicks;          ///< Measured plane periods (filtered)
+  uint32_t *rowHash;             ///< Canvas hash per row pair
+  void *paletteBits;             ///< PORT bits per plane per palette entry
   _PM_pin latch;                 ///< RGB data latch
   _PM_pin oe;                    ///< !OE (LOW out enable)
   _PM_pin *addr;                 ///< Array of address pins
+  void (*shiftSignal)(void);     ///< Deferred data shift trigger
   uint32_t bufferSize;           ///< Bytes per matrix buffer
   uint32_t bitZeroPeriod;        ///< Bitplane 0 timer period
   uint32_t minPeriod;            ///< Plane 0 timer period for ~250Hz
   volatile uint32_t frameCount;  ///< For estimating refresh rate
-  uint16_t width;                ///< Matrix chain width in bits
+  volatile uint32_t vblankCount; ///< Frames issued (never reset)
+  volatile uint32_t swapVblank;  ///< vblankCount at last buffer swap
+  volatile uint32_t dropped;     ///< Paced content frames missed
+  volatile uint32_t duplicated;  ///< Extra refreshes of late frames
+  volatile uint32_t lateShifts;  ///< Deferred shifts not done in time
+  uint32_t lateTicks;            ///< Plane extension while shift late
+  uint32_t timerPeriod;          ///< Period timer was last started with
+  uint32_t entryEighths;         ///< Interrupt entry latency, 1/8 ticks
+  uint32_t shiftTicks;           ///< Timer start to data out (filtered)
+  uint32_t overrunTicks;         ///< Last handler's run past its period
+  uint32_t pausedCount;          ///< Timer count when refresh paused
+  uint32_t frameTicks;           ///< Timer ticks so far this refresh
+  uint32_t refreshTicks;         ///< Measured ticks/refresh (filtered)
+  uint16_t targetFps;            ///< Paced frame rate (0=off)
+  uint16_t width;                ///< Chain width in bits, as stored
+  uint16_t paletteSize;          ///< Palette entries in paletteBits
+  uint16_t rowDelay;             ///< Address settle time (microseconds)
   uint8_t bytesPerElement;       ///< Using 8, 16 or 32 bits of PORT?
   uint8_t clockPin;              ///< RGB clock pin identifier
   uint8_t parallel;              ///< Number of concurrent matrix outs
   uint8_t numAddressLines;       ///< Number of address line pins
   uint8_t portOffset;            ///< Active 8- or 16-bit pos. in PORT
   uint8_t numPlanes;             ///< Display bitplanes (1 to 6)
-  uint8_t numRowPairs;           ///< Addressable row pairs
+  uint8_t numRowPairs;           ///< Addressable row pairs (max 32)
+  uint8_t swapInterval;          ///< Refreshes per paced frame (0=off)
+  uint8_t timerShift;            ///< Timer prescale (log2), if limited
+  uint8_t oeDelay;               ///< Latch-to-OE guard (microseconds)
+  uint8_t refinePlanes;          ///< Low planes left after coarse convert
+  uint8_t numRegions;            ///< Number of regions in use
   bool doubleBuffer;             ///< 2X buffers for clean switchover
   bool singleAddrPort;           ///< If 1, all addr lines on same PORT
+  bool directOut;                ///< If 1, write OUT reg (no toggle)
+  bool longElements;             ///< If 1, always 32-bit elements
+  bool doubleRows;               ///< If 1, each row shown twice
+  bool doubleColumns;            ///< If 1, each column shown twice
+  bool coalesce;                 ///< If 1, short planes handled inline
   volatile uint8_t activeBuffer; ///< Index of currently-displayed buf
   volatile uint8_t plane;        ///< Current bitplane (changes in ISR)
   volatile uint8_t row;          ///< Current scanline (changes in ISR)
   volatile uint8_t prevRow;      ///< Scanline from prior ISR
   volatile bool swapBuffers;     ///< If 1, awaiting double-buf switch
+  volatile bool paused;          ///< If 1, refresh is briefly suspended
+  volatile bool running;         ///< If 1, started and not stopped
+  volatile bool shiftPending;    ///< If 1, next plane awaits _PM_row_shift
+  volatile bool shifting;        ///< If 1, _PM_row_shift() in progress
+  bool staleBack;                ///< If 1, back buf older than front
+  bool hashValid;                ///< If 1, rowHash matches matrix data
+  bool rowHashing;               ///< If 1, convert skips unchanged rows
+  bool frameTimed;               ///< If 1, frameTicks began at vblank
+  // Canvas regions, see _PM_regionAdd()
+  _PM_region regions[_PM_MAX_REGIONS];        ///< Region rectangles
+  volatile uint8_t regionCommits[_PM_MAX_REGIONS]; ///< Commit count
+  volatile uint8_t regionShown[_PM_MAX_REGIONS];   ///< Count last shown
 } Protomatter_core;
 
 // Protomatter core function prototypes. Environment-specific code (like the
@@ -127,6 +227,8 @@ typedef struct {
   @param  addrCount     Number of row address lines required of matrix.
                         Total pixel height is then 2 x 2^addrCount, e.g.
                         32-pixel-tall matrices have 4 row address lines.
+                        Max 5 (A-E), so at most 32 row pairs; per-row
+                        bitmasks elsewhere rely on that.
   @param  addrList      A uint8_t array of pins (platform-dependent pin
                         numbering), one per row address line.
   @param  clockPin      RGB clock pin (platform-dependent pin #).
@@ -184,6 +286,29 @@ extern void _PM_stop(Protomatter_core *core);
 */
 extern void _PM_resume(Protomatter_core *core);
 
+/*!
+  @brief  Briefly suspend matrix refresh, e.g. so RGB data and clock pins
+          can be shared with another bus (SPI flash, SD card, etc.).
+          Sets OE HIGH and halts the timer, but unlike _PM_stop() leaves
+          the current plane, row, timing and buffer state intact, so
+          _PM_unpause() can pick up mid-frame in a few microseconds.
+          Address, latch and OE pins must NOT be shared.
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_pause(Protomatter_core *core);
+
+/*!
+  @brief  Continue matrix refresh following _PM_pause(). RGB data and
+          clock pins are made outputs again (one PORT direction register
+          write where the architecture has one), the pending bitplane is
+          reissued to the matrix (in case the shared bus clocked in junk),
+          and the interrupted plane resumes where it left off. Pins are
+          NOT switched back from a peripheral function; if the other bus
+          muxed them to one, hand them back to GPIO before calling this.
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_unpause(Protomatter_core *core);
+
 /*!
   @brief  Deallocate memory associated with Protomatter_core structure
           (e.g. screen data, pin lists for data and rows). Does not
@@ -199,6 +324,202 @@ extern void _PM_free(Protomatter_core *core);
 */
 extern void _PM_row_handler(Protomatter_core *core);
 
+/*!
+  @brief  Issue the next bitplane's data to the matrix, if the row
+          handler left it pending (see _PM_setDeferredShift()). Must be
+          called after every row handler call, before the next one;
+          typically from the lower-priority interrupt that the signal
+          function triggers.
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_row_shift(Protomatter_core *core);
+
+/*!
+  @brief  Split matrix refresh so the timer interrupt only does the
+          time-critical part (output enable, latch, row address, timer)
+          and shifting out the next plane's data (the long part, for
+          long chains) happens in _PM_row_shift(), which can run at a
+          lower priority so UART, USB, etc. aren't held off. The row
+          handler calls the signal function each time data is ready to
+          shift; it would typically pend a software or spare interrupt
+          whose handler calls _PM_row_shift(). If a shift isn't done in
+          time, the current plane is shown a little longer (or if never
+          started, the handler shifts it itself); see
+          _PM_getLateShifts().
+  @param  core    Pointer to Protomatter_core structure.
+  @param  signal  Function called (from the timer interrupt) when data is
+                  ready to shift, or NULL to shift in the row handler as
+                  usual (the default).
+*/
+extern void _PM_setDeferredShift(Protomatter_core *core,
+                                 void (*signal)(void));
+
+/*!
+  @brief  Enable or disable interrupt coalescing (off by default). When
+          a bitplane would end no later than the next plane's data shift
+          plus interrupt exit and entry (as measured, see
+          _PM_getRowCost()), the row handler waits it out and handles the
+          next plane in the same interrupt, rather than returning and
+          taking another; at high bit depths on slower devices, the low
+          planes' interrupts are otherwise a large share of CPU time.
+          Costs a little latency for other interrupts of the same or
+          lower priority.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  enable  true to enable, false to disable.
+*/
+extern void _PM_setCoalescing(Protomatter_core *core, bool enable);
+
+/*!
+  @brief  Enable or disable row change detection in _PM_convert_565() (on
+          by default). Hashing a row pair's canvas pixels is much cheaper
+          than converting them, but when nearly every row changes every
+          frame it's wasted time; with it off, every call converts the
+          whole canvas. Also handy for timing the conversion itself.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  enable  true to enable, false to disable.
+*/
+extern void _PM_setRowHashing(Protomatter_core *core, bool enable);
+
+/*!
+  @brief  Returns the number of times the row handler found a deferred
+          shift not yet done (see _PM_setDeferredShift()), and resets it
+          to zero. Non-zero means the shifting context is running late,
+          which costs refresh rate (planes are stretched to wait for it).
+  @param  core  Pointer to Protomatter_core structure.
+  @return Late shift count since previous call.
+*/
+extern uint32_t _PM_getLateShifts(Protomatter_core *core);
+
+/*!
+  @brief  Set the relative display time of each bitplane, replacing the
+          default binary weighting (each plane twice the time of the one
+          before). Non-binary weights can apply gamma in the time domain,
+          extend resolution at the dark end, or compensate for interrupt
+          overhead that lengthens the shortest planes.
+  @param  core     Pointer to Protomatter_core structure.
+  @param  weights  Array of numPlanes relative weights, least significant
+                   plane first, in any units; all are scaled relative to
+                   weights[0] (ratios up to 255:1). e.g. {1, 2, 4, 8, 16,
+                   32} is the default for 6 planes.
+  @return PROTOMATTER_OK on success, PROTOMATTER_ERR_ARG if core has not
+          been started with _PM_begin() or weights[0] is zero.
+*/
+extern ProtomatterStatus _PM_setPlaneWeights(Protomatter_core *core,
+                                             const uint16_t *weights);
+
+/*!
+  @brief  Always store matrix data as 32-bit, PORT-aligned elements, even
+          if the RGB data pins would fit within one byte or word. Uses 2X
+          or 4X the matrix RAM, but on devices limited to 32-bit GPIO
+          access (_PM_STRICT_32BIT_IO in arch.h, e.g. i.MX RT in Teensy
+          4.x) this removes a shift per column from the innermost loop.
+          Little or no benefit elsewhere.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  enable  true for 32-bit elements, false (default) to size
+                  elements to the RGB pin layout.
+  @note   Call after _PM_init() and before _PM_begin(); ignored otherwise.
+*/
+extern void _PM_setLongElements(Protomatter_core *core, bool enable);
+
+/*!
+  @brief  Enable or disable direct writes to the PORT OUT register when
+          issuing RGB data, on devices without a toggle register. This
+          cuts PORT writes per column from three to two (a big part of
+          refresh time on e.g. nRF52), but other pins on the same PORT
+          as the RGB data and clock must NOT be changed by any interrupt
+          of higher priority than the matrix timer, or by DMA, while
+          enabled. Address, latch and OE pins are fine there. Not used
+          while a deferred shift is set (_PM_setDeferredShift()): data
+          is then issued below matrix timer priority, where any interrupt
+          writing that PORT would have its change undone. The setting is
+          kept and applies again once the deferred shift is cleared.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  enable  true to enable, false to use set/clear registers.
+  @return true if direct writes are now in use, false if disabled, not
+          available (toggle register or combined set/clear present) or
+          suspended by a deferred shift.
+*/
+extern bool _PM_setDirectOut(Protomatter_core *core, bool enable);
+
+/*!
+  @brief  Define a rectangle of the canvas that's drawn and committed on
+          its own, e.g. by a separate task (a clock, a ticker, sensor
+          tiles). Producers draw only inside their own region, then call
+          _PM_regionCommit(); _PM_regionShow() converts whatever's been
+          committed and swaps once. Regions shouldn't overlap.
+  @param  core  Pointer to Protomatter_core structure.
+  @param  x     Left edge, in pixels.
+  @param  y     Top edge, in pixels.
+  @param  w     Width, in pixels.
+  @param  h     Height, in pixels.
+  @return Region index, or -1 if all _PM_MAX_REGIONS are in use.
+*/
+extern int8_t _PM_regionAdd(Protomatter_core *core, int16_t x, int16_t y,
+                            int16_t w, int16_t h);
+
+/*!
+  @brief  Mark a region as ready to show. Increments a per-region commit
+          count that only that region's producer writes (_PM_regionShow()
+          keeps its own count), so producers on other tasks or cores can
+          call it without locking. Each region must have a single
+          producer; commits to one region from several tasks or cores
+          are not supported, as they could lose a count. Wait for
+          _PM_regionPending() to return false before drawing to the
+          region again, or the conversion might catch it half-drawn. That
+          happens only once the region has been converted and swapped in,
+          and a commit made while it's converting is kept for next time.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  region  Index returned by _PM_regionAdd().
+*/
+extern void _PM_regionCommit(Protomatter_core *core, uint8_t region);
+
+/*!
+  @brief  Query whether a region's last commit is still waiting to be
+          converted.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  region  Index returned by _PM_regionAdd().
+  @return true if committed but not yet converted.
+*/
+extern bool _PM_regionPending(Protomatter_core *core, uint8_t region);
+
+/*!
+  @brief  Remove all regions.
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_regionClear(Protomatter_core *core);
+
+/*!
+  @brief  Set panel timing parameters. The defaults (_PM_panelDefault)
+          suit the slowest panels; many settle faster after a row address
+          change, and with several address lines changing per row that
+          delay can be several percent of each frame. _PM_panelFast skips
+          it entirely, or pass a custom profile. Can be called at any
+          time, e.g. to tune while watching the matrix.
+  @param  core     Pointer to Protomatter_core structure.
+  @param  profile  Pointer to profile, values are copied.
+*/
+extern void _PM_setPanelProfile(Protomatter_core *core,
+                                const _PM_panelProfile *profile);
+
+/*!
+  @brief  Display each pixel as a 2x1, 1x2 or 2x2 block of LEDs, for low-
+          resolution content on a larger matrix. The matrix buffer holds
+          only the lower-resolution image, 1/2 or 1/4 the usual size, and
+          conversion functions take that size source image; pixels are
+          repeated by the row handler when issued to the matrix. Direct
+          OUT writes (_PM_setDirectOut()) aren't used while columns are
+          doubled. Must be called after _PM_init() and before _PM_begin().
+  @param  core     Pointer to Protomatter_core structure.
+  @param  columns  If true, each column is shown twice (chain width must
+                   be even).
+  @param  rows     If true, each row is shown twice (needs at least one
+                   address line).
+  @return true on success, false if already started or not possible with
+          this matrix.
+*/
+extern bool _PM_setPixelDoubling(Protomatter_core *core, bool columns,
+                                 bool rows);
+
 /*!
   @brief  Returns current value of frame counter and resets its value to
           zero. Two calls to this, timed one second apart (or use math with
@@ -210,6 +531,225 @@ extern void _PM_row_handler(Protomatter_core *core);
 */
 extern uint32_t _PM_getFrameCount(Protomatter_core *core);
 
+/*!
+  @brief  Get measured display time of each bitplane, as captured by the
+          row handler, versus requested time (see _PM_setPlaneWeights()),
+          plus the ratio between successive planes (ideally 2:1), for
+          quantifying bit-angle modulation distortion while tuning bit
+          depth, chain length and so forth.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  timing  Array of _PM_planeTiming structs, one per bitplane
+                  (numPlanes elements), to be filled in.
+  @return Number of elements filled in (numPlanes, or 0 if not started).
+*/
+extern uint8_t _PM_getPlaneTiming(Protomatter_core *core,
+                                  _PM_planeTiming *timing);
+
+/*!
+  @brief  Get the row handler's cost on this device and configuration:
+          PORT writes per column of data issued, and the filtered
+          interrupt entry and data shift times (for benchmarking; ticks
+          times F_CPU / timerFreq gives CPU cycles). These are measured
+          whether or not interrupt coalescing is enabled, though the
+          shift time isn't while deferred shifts are (see
+          _PM_setDeferredShift()).
+  @param  core  Pointer to Protomatter_core structure.
+  @param  cost  Pointer to _PM_rowCost struct to be filled in.
+  @return true on success, false if not started.
+*/
+extern bool _PM_getRowCost(Protomatter_core *core, _PM_rowCost *cost);
+
+/*!
+  @brief  Wait until the current frame has been fully issued to the matrix
+          (i.e. the next vertical blank). Where the architecture provides
+          it (see _PM_vblankWait() in arch.h), the calling task blocks
+          rather than spinning, freeing the CPU for other tasks. Returns
+          immediately if the matrix is not running or is paused.
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_waitVblank(Protomatter_core *core);
+
+/*!
+  @brief  Set a target animation rate for a double-buffered matrix. Swaps
+          are then scheduled so each frame passed to _PM_swapbuffer_maybe()
+          is displayed for the same whole number of matrix refreshes,
+          rather than however long the refresh rate (which varies with
+          timer adaptation) happens to line up with the application's own
+          timing. The row handler measures each refresh and adjusts the
+          number of refreshes per frame as the refresh rate settles or
+          drifts, so this can be called right after _PM_begin().
+  @param  core  Pointer to Protomatter_core structure.
+  @param  fps   Target frames per second, or 0 to disable pacing (swap at
+                the next refresh, the default).
+  @return Initial matrix refreshes per frame, estimated from the current
+          plane periods (0 if pacing is off or the matrix is not
+          double-buffered). Actual frame rate is the refresh rate divided
+          by core->swapInterval, which may later change.
+*/
+extern uint8_t _PM_setFrameRate(Protomatter_core *core, uint16_t fps);
+
+/*!
+  @brief  Get and reset frame pacing statistics (see _PM_setFrameRate()).
+          A frame that's swapped in late (e.g. rendering took too long)
+          stays on the matrix for extra refreshes, counted as duplicated;
+          each full frame interval missed that way also counts as a
+          dropped frame.
+  @param  core        Pointer to Protomatter_core structure.
+  @param  dropped     Pointer to receive dropped frame count since previous
+                      call (or NULL).
+  @param  duplicated  Pointer to receive duplicated refresh count since
+                      previous call (or NULL).
+*/
+extern void _PM_getFrameStats(Protomatter_core *core, uint32_t *dropped,
+                              uint32_t *duplicated);
+
+/*!
+  @brief  Get the matrix buffer for writing directly, element by element
+          (see _PM_editSeek()). If double-buffered this is the back
+          buffer, brought up to date with the displayed one if it was
+          swapped since the last full conversion.
+  @param  core  Pointer to Protomatter_core structure.
+  @return Pointer to start of matrix buffer, or NULL if not started.
+*/
+extern void *_PM_editBuffer(Protomatter_core *core);
+
+/*!
+  @brief  Position a cursor at one pixel of one bitplane line of the
+          matrix buffer, to rewrite elements from there on with
+          _PM_editNext(). Elements stay encoded as this device requires
+          (toggle, set/clear or plain) throughout, so the buffer can be
+          edited while it's being displayed; with toggle encoding each
+          element holds the change from the one before it, so seeking
+          reads (but doesn't change) the line up to x.
+  @param  core   Pointer to Protomatter_core structure.
+  @param  ed     Pointer to cursor to initialize.
+  @param  buf    Matrix buffer, from _PM_editBuffer().
+  @param  row    Row pair (0 to numRowPairs-1).
+  @param  plane  Bitplane (0 to numPlanes-1).
+  @param  x      Pixel column.
+*/
+extern void _PM_editSeek(Protomatter_core *core, _PM_editCursor *ed,
+                         void *buf, uint8_t row, uint8_t plane, int16_t x);
+
+/*!
+  @brief  Rewrite selected RGB bits of the element at the cursor and move
+          to the next one. Elements whose bits don't change aren't
+          written.
+  @param  core  Pointer to Protomatter_core structure.
+  @param  ed    Pointer to cursor, from _PM_editSeek().
+  @param  mask  RGB pin bits to change (0 to just read the element).
+  @param  bits  New values of those bits.
+  @return Plain RGB bits of the element before the change, one per RGB
+          pin (see rgbMask).
+*/
+extern uint32_t _PM_editNext(Protomatter_core *core, _PM_editCursor *ed,
+                             uint32_t mask, uint32_t bits);
+
+/*!
+  @brief  Finish a run of _PM_editNext() calls. With toggle encoding the
+          element following the last one written is fixed up to toggle
+          from its new predecessor; must be called before that element
+          is displayed, or anything else in the line is edited.
+  @param  core  Pointer to Protomatter_core structure.
+  @param  ed    Pointer to cursor, from _PM_editSeek().
+*/
+extern void _PM_editClose(Protomatter_core *core, _PM_editCursor *ed);
+
+/*!
+  @brief  Start writing an indexed-color (palette) image directly to the
+          matrix buffer, e.g. from a GIF decoder, bypassing any 565 canvas
+          and full conversion. The palette is expanded once here to per-
+          bitplane PORT bits, lines of color indices are then written with
+          _PM_paletteLine(), and _PM_paletteEnd() finishes the frame.
+          Areas of the matrix not written keep their prior contents. If
+          double-buffered, applies to the back buffer (see
+          _PM_editBuffer()), call _PM_swapbuffer_maybe() after
+          _PM_paletteEnd() to show it.
+  @param  core     Pointer to Protomatter_core structure.
+  @param  palette  Array of 565 colors.
+  @param  count    Number of palette entries (1 to 256 for GIF).
+  @return A ProtomatterStatus status type, one of:
+          PROTOMATTER_OK on success.
+          PROTOMATTER_ERR_ARG if core or palette is NULL, count is zero
+          or begin() has not been called.
+          PROTOMATTER_ERR_MALLOC if palette table could not be allocated.
+*/
+extern ProtomatterStatus _PM_paletteBegin(Protomatter_core *core,
+                                          const uint16_t *palette,
+                                          uint16_t count);
+
+/*!
+  @brief  Write one line (or part of a line) of palette indices to the
+          matrix buffer. Must be between _PM_paletteBegin() and
+          _PM_paletteEnd(). Pixels outside the matrix are clipped and
+          indices beyond the palette size are skipped (left as-is, e.g.
+          for GIF transparency, pass an index >= palette count).
+  @param  core     Pointer to Protomatter_core structure.
+  @param  x        Left edge of line segment, in pixels.
+  @param  y        Matrix row, in pixels.
+  @param  indices  Array of palette indices, one per pixel.
+  @param  w        Number of pixels in indices array.
+*/
+extern void _PM_paletteLine(Protomatter_core *core, int16_t x, int16_t y,
+                            const uint8_t *indices, uint16_t w);
+
+/*!
+  @brief  Finish writing a palette image following _PM_paletteBegin().
+  @param  core  Pointer to Protomatter_core structure.
+*/
+extern void _PM_paletteEnd(Protomatter_core *core);
+
+/*!
+  @brief  Get size of a pre-encoded matrix payload for _PM_loadPayload().
+          The payload is an exact image of one matrix buffer: for each row
+          pair, for each bitplane, one line of elements (bytesPerElement
+          each, width rounded up to the arch's chunk size, padding first),
+          encoded as this device does (toggle, set/clear or plain, see
+          _PM_editSeek()) using the PORT bits in rgbMask.
+  @param  core  Pointer to Protomatter_core structure.
+  @return Payload size in bytes, or 0 if not started.
+*/
+extern uint32_t _PM_payloadSize(Protomatter_core *core);
+
+/*!
+  @brief  Copy pre-encoded matrix data (see _PM_payloadSize()) directly
+          into the matrix buffer, e.g. a frame prepared for this board by
+          a video wall controller, avoiding any conversion. May be called
+          repeatedly with successive chunks as data arrives. If double-
+          buffered this is the back buffer, call _PM_swapbuffer_maybe()
+          once the whole frame is loaded.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  data    Pointer to payload data (or chunk thereof).
+  @param  offset  Byte offset of data within payload.
+  @param  length  Number of bytes to copy.
+  @return A ProtomatterStatus status type, one of:
+          PROTOMATTER_OK on success.
+          PROTOMATTER_ERR_ARG if not started or data would extend past the
+          end of the matrix buffer.
+*/
+extern ProtomatterStatus _PM_loadPayload(Protomatter_core *core,
+                                         const void *data, uint32_t offset,
+                                         uint32_t length);
+
+/*!
+  @brief  Shift a rectangular region of the matrix image by some number
+          of pixels horizontally and/or vertically, working directly on
+          matrix data rather than reconverting. Pixels shifted in from
+          outside the region are cleared to black, the caller can then
+          fill in just that strip with _PM_convert_565_rect(). If double-
+          buffered, this applies to the back buffer (see
+          _PM_editBuffer()), call _PM_swapbuffer_maybe() to show it.
+  @param  core  Pointer to Protomatter_core structure.
+  @param  x     Left edge of region, in pixels.
+  @param  y     Top edge of region, in pixels.
+  @param  w     Width of region, in pixels.
+  @param  h     Height of region, in pixels.
+  @param  dx    Horizontal shift in pixels, positive = right.
+  @param  dy    Vertical shift in pixels, positive = down.
+*/
+extern void _PM_scroll(Protomatter_core *core, int16_t x, int16_t y,
+                       int16_t w, int16_t h, int16_t dx, int16_t dy);
+
 /*!
   @brief  Start (or restart) a timer/counter peripheral.
   @param  tptr    Pointer to timer/counter peripheral OR a struct
@@ -239,7 +779,10 @@ extern uint32_t _PM_timerGetCount(void *tptr);
 
 /*!
   @brief  Converts image data from GFX16 canvas to the matrices weird
-          internal format.
+          internal format. Row pairs whose canvas pixels are unchanged
+          since the last call (going by a hash of each) are skipped;
+          any other change to the matrix data makes the next call
+          convert everything (see also _PM_setRowHashing()).
   @param  core    Pointer to Protomatter_core structure.
   @param  source  Pointer to source image data (see Adafruit_GFX 16-bit
                   canvas type for format).
@@ -249,6 +792,93 @@ extern uint32_t _PM_timerGetCount(void *tptr);
 extern void _PM_convert_565(Protomatter_core *core, uint16_t *source,
                             uint16_t width);
 
+/*!
+  @brief  Converts a rectangular region of a GFX16 canvas to the matrix
+          buffer, leaving the rest of the matrix buffer as-is. Much
+          faster than _PM_convert_565() when only part of the image has
+          changed. If double-buffered, the data goes to the back buffer
+          (first brought up to date with the displayed one) as usual;
+          call _PM_swapbuffer_maybe() afterward.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  source  Pointer to source image data, full canvas (not just the
+                  region).
+  @param  width   Width of canvas in pixels.
+  @param  x       Left edge of region, in pixels.
+  @param  y       Top edge of region, in pixels.
+  @param  w       Width of region, in pixels.
+  @param  h       Height of region, in pixels.
+*/
+extern void _PM_convert_565_rect(Protomatter_core *core, uint16_t *source,
+                                 uint16_t width, int16_t x, int16_t y,
+                                 int16_t w, int16_t h);
+
+/*!
+  @brief  Update individual pixels in the matrix buffer, e.g. for particle
+          simulations where only a small fraction of pixels change each
+          frame. Each change is given as the XOR of the pixel's previous
+          and new 565 colors (the caller is expected to know the prior
+          color, e.g. from a canvas), which lets the matrix data be
+          patched in place in any order, with cost proportional to the
+          number of changes rather than panel size. If double-buffered,
+          applies to the back buffer (see _PM_editBuffer()), call
+          _PM_swapbuffer_maybe() to show.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  pixels  Array of pixel changes. Out-of-bounds entries and zero
+                  deltas are skipped.
+  @param  count   Number of elements in pixels array.
+*/
+extern void _PM_convert_565_xor(Protomatter_core *core,
+                                const _PM_pixel *pixels, uint16_t count);
+
+/*!
+  @brief  Converts only the most significant bitplanes of a GFX16 canvas
+          (lower planes are blanked), for a quick coarse update of fast-
+          changing content. Swap (if double-buffered) right away, then
+          fill in the remaining planes with _PM_convert_565_refine().
+          Lower planes carry little of the image, so the coarse frame
+          looks close to the real thing and is ready sooner.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  source  Pointer to source image data.
+  @param  width   Width of canvas in pixels.
+  @param  planes  Number of top planes to convert now (1 to numPlanes,
+                  out-of-range values convert everything).
+*/
+extern void _PM_convert_565_coarse(Protomatter_core *core, uint16_t *source,
+                                   uint16_t width, uint8_t planes);
+
+/*!
+  @brief  Converts the next lower bitplanes following
+          _PM_convert_565_coarse(). If double-buffered, the refined frame
+          is built in the back buffer (call after the coarse frame's
+          swap), swap again after each call. Otherwise it's written
+          straight to the displayed buffer, and a line being issued at
+          that moment shows garbage in that plane for one refresh. Call
+          repeatedly, e.g. once per loop, until it returns 0. Canvas must
+          not change meanwhile; a full _PM_convert_565() cancels any
+          refinement.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  source  Pointer to source image data, same as coarse call.
+  @param  width   Width of canvas in pixels.
+  @param  planes  Number of planes to convert in this call.
+  @return Number of planes still to be converted.
+*/
+extern uint8_t _PM_convert_565_refine(Protomatter_core *core,
+                                      uint16_t *source, uint16_t width,
+                                      uint8_t planes);
+
+/*!
+  @brief  Converts all regions committed since the last call (see
+          _PM_regionAdd()) from a GFX16 canvas to the matrix buffer, then
+          swaps (if double-buffered) once for all of them. Call from one
+          task only. Does nothing (no swap) if no region is committed.
+  @param  core    Pointer to Protomatter_core structure.
+  @param  source  Pointer to source image data, full canvas.
+  @param  width   Width of canvas in pixels.
+  @return Number of regions converted.
+*/
+extern uint8_t _PM_regionShow(Protomatter_core *core, uint16_t *source,
+                              uint16_t width);
+
 /*!
   @brief  Pauses until the next vertical blank to avoid 'tearing' animation
           (if display is double-buffered). If single-buffered, has no effect.
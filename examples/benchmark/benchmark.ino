@@ -0,0 +1,177 @@
+#include "Adafruit_Protomatter.h"
+
+/*
+Throughput benchmark: times conversion from the GFX canvas to the matrix
+framebuffer (show()), with every row changed, with none changed (so only
+change detection runs) and with change detection off (conversion alone),
+and measures the resulting refresh rate,
+bitplane timing and row handler cost (PORT writes per column, interrupt
+CPU cycles per row). Results go to Serial as one JSON object per line so
+they can be logged and compared between library versions or
+configurations; compare.py in this folder checks a log against a stored
+baseline and flags regressions. Edit WIDTH, DEPTH, DOUBLE_BUFFER and the
+pins below to match the setup being tested (see the "protomatter" example
+for pinout notes).
+*/
+
+#define WIDTH         64    // Matrix chain width in pixels
+#define DEPTH         6     // Bitplanes (1-6)
+#define DOUBLE_BUFFER false // true = double-buffered
+#define SHOW_REPS     50    // Conversions to time for average
+
+#if defined(__SAMD51__)
+  // Use FeatherWing pinout
+  uint8_t rgbPins[]  = {6, 5, 9, 11, 10, 12};
+  uint8_t addrPins[] = {A5, A4, A3, A2};
+  uint8_t clockPin   = 13;
+  uint8_t latchPin   = 0;
+  uint8_t oePin      = 1;
+#elif defined(_SAMD21_)
+  uint8_t rgbPins[]  = {6, 7, 10, 11, 12, 13};
+  uint8_t addrPins[] = {0, 1, 2, 3};
+  uint8_t clockPin   = SDA;
+  uint8_t latchPin   = 4;
+  uint8_t oePin      = 5;
+#elif defined(NRF52_SERIES)
+  // Special nRF52840 FeatherWing pinout
+  uint8_t rgbPins[]  = {6, A5, A1, A0, A4, 11};
+  uint8_t addrPins[] = {10, 5, 13, 9};
+  uint8_t clockPin   = 12;
+  uint8_t latchPin   = PIN_SERIAL1_RX;
+  uint8_t oePin      = PIN_SERIAL1_TX;
+#elif defined(ESP32)
+  // 'Safe' pins (not overlapping any peripherals):
+  // GPIO.out: 4, 12, 13, 14, 15, 21, 27, GPIO.out1: 32, 33
+  // Peripheral-overlapping pins, sorted from 'most expendible':
+  // 16, 17 (RX, TX), 25, 26 (A0, A1), 18, 5, 9 (MOSI, SCK, MISO), 22, 23 (SCL, SDA)
+  uint8_t rgbPins[]  = {4, 12, 13, 14, 15, 21};
+  uint8_t addrPins[] = {16, 17, 25, 26};
+  uint8_t clockPin   = 27; // Must be on same port as rgbPins
+  uint8_t latchPin   = 32;
+  uint8_t oePin      = 33;
+#elif defined(ARDUINO_TEENSY40)
+  uint8_t rgbPins[]  = {15, 16, 17, 20, 21, 22}; // A1-A3, A6-A8, skips SDA,SCL
+  uint8_t addrPins[] = {2, 3, 4, 5};
+  uint8_t clockPin   = 23; // A9
+  uint8_t latchPin   = 6;
+  uint8_t oePin      = 9;
+#elif defined(ARDUINO_TEENSY41)
+  uint8_t rgbPins[]  = {26, 27, 38, 20, 21, 22}; // A12-14, A6-A8 (yes that's a 38, NOT 28!)
+  uint8_t addrPins[] = {2, 3, 4, 5};
+  uint8_t clockPin   = 23; // A9
+  uint8_t latchPin   = 6;
+  uint8_t oePin      = 9;
+#endif
+
+Adafruit_Protomatter matrix(
+  WIDTH, DEPTH, 1, rgbPins, 4, addrPins, clockPin, latchPin, oePin,
+  DOUBLE_BUFFER);
+
+void setup(void) {
+  Serial.begin(9600);
+  while(!Serial) delay(10);
+
+  ProtomatterStatus status = matrix.begin();
+  if(status != PROTOMATTER_OK) {
+    Serial.print("{\"error\":");
+    Serial.print((int)status);
+    Serial.println("}");
+    for(;;);
+  }
+
+  // Random noise, so no conversion shortcuts apply
+  for(int y=0; y<matrix.height(); y++) {
+    for(int x=0; x<matrix.width(); x++) {
+      matrix.drawPixel(x, y, random(0x10000));
+    }
+  }
+}
+
+// Average microseconds per show() over SHOW_REPS calls. If 'change' is
+// set, a vertical line is drawn first; it touches every row, so none are
+// skipped as unchanged. Otherwise the canvas is left alone and show()
+// is down to change detection (plus, if double-buffered, the swap).
+// Only show() itself is timed, not the drawing.
+uint32_t timeShow(bool change) {
+  uint32_t total = 0;
+  for(int i=0; i<SHOW_REPS; i++) {
+    if(change) {
+      matrix.drawFastVLine(i % matrix.width(), 0, matrix.height(),
+        random(0x10000));
+    }
+    uint32_t t = micros();
+    matrix.show();
+    total += micros() - t;
+  }
+  return total / SHOW_REPS;
+}
+
+uint32_t nsPerPixel(uint32_t us) {
+  uint32_t pixels = (uint32_t)matrix.width() * matrix.height();
+  return (uint32_t)((uint64_t)us * 1000 / pixels);
+}
+
+// Timer ticks to CPU cycles
+uint32_t cycles(uint32_t ticks, uint32_t timerFreq) {
+  return (uint32_t)((uint64_t)ticks * F_CPU / timerFreq);
+}
+
+void loop(void) {
+  uint32_t changedMicros = timeShow(true);
+  uint32_t unchangedMicros = timeShow(false);
+  matrix.setRowHashing(false); // Every show() converts everything
+  uint32_t convertMicros = timeShow(false);
+  matrix.setRowHashing(true);
+
+  // Refresh rate over one second
+  (void)matrix.getFrameCount();
+  delay(1000);
+  uint32_t fps = matrix.getFrameCount();
+
+  _PM_planeTiming timing[6];
+  uint8_t planes = matrix.getPlaneTiming(timing);
+  _PM_rowCost cost;
+  matrix.getRowCost(&cost);
+  uint32_t entryCycles = cycles(cost.entryTicks, cost.timerFreq);
+  uint32_t shiftCycles = cycles(cost.shiftTicks, cost.timerFreq);
+
+  Serial.print("{\"width\":");
+  Serial.print(matrix.width());
+  Serial.print(",\"height\":");
+  Serial.print(matrix.height());
+  Serial.print(",\"depth\":");
+  Serial.print(DEPTH);
+  Serial.print(",\"doubleBuffer\":");
+  Serial.print(DOUBLE_BUFFER ? "true" : "false");
+  Serial.print(",\"elementBytes\":");
+  Serial.print(cost.elementBytes);
+  Serial.print(",\"showMicros\":");
+  Serial.print(changedMicros);
+  Serial.print(",\"nsPerPixel\":");
+  Serial.print(nsPerPixel(changedMicros));
+  Serial.print(",\"unchangedMicros\":");
+  Serial.print(unchangedMicros);
+  Serial.print(",\"unchangedNsPerPixel\":");
+  Serial.print(nsPerPixel(unchangedMicros));
+  Serial.print(",\"convertMicros\":");
+  Serial.print(convertMicros);
+  Serial.print(",\"refreshHz\":");
+  Serial.print(fps);
+  Serial.print(",\"portWritesPerColumn\":");
+  Serial.print(cost.portWrites);
+  Serial.print(",\"entryCycles\":");
+  Serial.print(entryCycles);
+  Serial.print(",\"isrCyclesPerRow\":");
+  Serial.print(entryCycles + shiftCycles);
+  Serial.print(",\"planeTicks\":[");
+  for(uint8_t p=0; p<planes; p++) {
+    if(p) Serial.print(",");
+    Serial.print(timing[p].ticks);
+  }
+  Serial.print("],\"planeError\":[");
+  for(uint8_t p=0; p<planes; p++) {
+    if(p) Serial.print(",");
+    Serial.print(timing[p].error);
+  }
+  Serial.println("]}");
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Compare benchmark.ino results against a stored baseline.
+
+Both files are Serial logs from the benchmark sketch (one JSON object per
+line; other lines are ignored), e.g. captured from each library version
+and each WIDTH/DEPTH/DOUBLE_BUFFER setup being evaluated. Results are
+matched up by configuration, the median of each metric is taken (the
+sketch repeats), and any metric worse than the baseline by more than the
+threshold is reported. Exit status is 1 if anything regressed, so this
+can gate a rollout.
+
+    python3 compare.py baseline.log current.log [--threshold PERCENT]
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+# Fields identifying a configuration
+CONFIG = ("width", "height", "depth", "doubleBuffer", "elementBytes")
+
+# Metrics compared, and whether higher values are better
+METRICS = {
+    "showMicros": False,
+    "nsPerPixel": False,
+    "unchangedMicros": False,
+    "unchangedNsPerPixel": False,
+    "convertMicros": False,
+    "refreshHz": True,
+    "portWritesPerColumn": False,
+    "entryCycles": False,
+    "isrCyclesPerRow": False,
+}
+
+
+def load(path):
+    """Return {config tuple: {metric: [values]}} from a benchmark log."""
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            try:
+                record = json.loads(line)
+            except ValueError:
+                continue  # Partial line, serial noise, etc.
+            if "error" in record:
+                continue
+            key = tuple(record.get(field) for field in CONFIG)
+            metrics = results.setdefault(key, {})
+            for name in METRICS:
+                if name in record:
+                    metrics.setdefault(name, []).append(record[name])
+            # Worst bitplane timing error, in 1/1000
+            if record.get("planeError"):
+                worst = max(abs(e) for e in record["planeError"])
+                metrics.setdefault("planeErrorMax", []).append(worst)
+    return results
+
+
+def describe(key):
+    return ", ".join("%s=%s" % (f, v) for f, v in zip(CONFIG, key))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("baseline", help="Stored baseline benchmark log")
+    parser.add_argument("current", help="Benchmark log to check")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=5.0,
+        help="Allowed change for the worse, percent (default 5)",
+    )
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    higher = dict(METRICS, planeErrorMax=False)
+    regressions = 0
+
+    for key in sorted(current, key=str):
+        if key not in baseline:
+            print("%s: no baseline, skipped" % describe(key))
+            continue
+        print("%s:" % describe(key))
+        for name, values in sorted(current[key].items()):
+            if name not in baseline[key]:
+                continue
+            old = statistics.median(baseline[key][name])
+            new = statistics.median(values)
+            if old:
+                change = (new - old) * 100.0 / abs(old)
+            else:
+                change = 0.0 if new == old else float("inf")
+            worse = -change if higher[name] else change
+            flag = ""
+            if worse > args.threshold:
+                flag = "  REGRESSION"
+                regressions += 1
+            print(
+                "  %-20s %10g -> %10g  %+7.1f%%%s"
+                % (name, old, new, change, flag)
+            )
+
+    for key in sorted(baseline, key=str):
+        if key not in current:
+            print("%s: missing from current results" % describe(key))
+
+    print("%d regression(s) beyond %g%%" % (regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -155,6 +155,11 @@ void setup(void) {
   matrix.setTextWrap(false);
   matrix.setTextSize(2);
   matrix.setTextColor(0xFFFF); // White
+
+  // Show a new frame every so many matrix refreshes (~50 per second),
+  // rather than using delay(), so motion is smooth. The library adjusts
+  // the number of refreshes per frame as the refresh rate settles.
+  matrix.setFrameRate(50);
 }
 
 void loop(void) {
@@ -186,7 +191,5 @@ void loop(void) {
   hue += 7;
   if(hue >= 1536) hue -= 1536;
 
-  matrix.show();
-
-  delay(20);
+  matrix.show(); // Waits for this frame's turn (see setFrameRate())
 }
@@ -30,6 +30,11 @@ Adafruit_PixelDust sand(WIDTH, HEIGHT, N_GRAINS, 1, 128, false);
 
 uint32_t        prevTime   = 0;      // Used for frames-per-second throttle
 
+// Previous grain positions, and list of pixel changes for each frame
+// (each moving grain erases its old pixel and draws a new one).
+dimension_t prevX[N_GRAINS], prevY[N_GRAINS];
+_PM_pixel   changes[N_GRAINS * 2];
+
 // SETUP - RUNS ONCE AT PROGRAM START --------------------------------------
 
 void err(int x) {
@@ -84,6 +89,15 @@ void setup(void) {
   colors[5] = color565(  0,128, 38);   // Green
   colors[6] = color565(  0, 77,255);   // Blue
   colors[7] = color565(117,  7,135); // Purple  
+
+  // Draw all grains once, subsequent frames only update moved grains
+  matrix.fillScreen(0x0);
+  for(int i=0; i<N_GRAINS ; i++) {
+    sand.getPosition(i, &prevX[i], &prevY[i]);
+    int n = i / ((WIDTH / N_COLORS) * BOX_HEIGHT); // Color index
+    matrix.drawPixel(prevX[i], prevY[i], colors[n]);
+  }
+  matrix.show();
 }
 
 uint16_t color565(uint8_t red, uint8_t green, uint8_t blue) {
@@ -115,17 +129,30 @@ void loop() {
   
   //sand.iterate(-accel.y, accel.x, accel.z);
 
-  // Update pixel data in LED driver
+  // Update pixel data in LED driver. Rather than clearing and redrawing
+  // everything, only grains that moved are changed: erase all their old
+  // positions first (one may move into a spot another just left), then
+  // draw the new ones.
   dimension_t x, y;
-  matrix.fillScreen(0x0);
+  uint16_t nChanges = 0;
   for(int i=0; i<N_GRAINS ; i++) {
     sand.getPosition(i, &x, &y);
-    int n = i / ((WIDTH / N_COLORS) * BOX_HEIGHT); // Color index
-    uint16_t flakeColor = colors[n];
-    matrix.drawPixel(x, y, flakeColor);
-    //Serial.printf("(%d, %d)\n", x, y);
+    if((x != prevX[i]) || (y != prevY[i])) {
+      changes[nChanges].x       = prevX[i];
+      changes[nChanges].y       = prevY[i];
+      changes[nChanges++].color = 0;
+    }
+  }
+  for(int i=0; i<N_GRAINS ; i++) {
+    sand.getPosition(i, &x, &y);
+    if((x != prevX[i]) || (y != prevY[i])) {
+      int n = i / ((WIDTH / N_COLORS) * BOX_HEIGHT); // Color index
+      changes[nChanges].x       = prevX[i] = x;
+      changes[nChanges].y       = prevY[i] = y;
+      changes[nChanges++].color = colors[n];
+    }
   }
-  matrix.show(); // Copy data to matrix buffers
+  matrix.showPixels(changes, nChanges); // Copy changes to matrix buffers
   
 
 }
@@ -0,0 +1,239 @@
+/*!
+ * @file camera.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Rolling-shutter camera capture of the emulated matrix (see host.h), for
+ * judging refresh rate, depth and plane timing against the banding
+ * cameras see on scanned matrices. Sensor rows start exposing one line
+ * time apart, each integrating the matrix's light over the exposure time,
+ * and rows covering the matrix are mapped evenly onto its pixel rows.
+ *
+ * Each captured frame's banding is reported as the standard deviation of
+ * the sensor rows' mean levels over their mean (0 for an even capture).
+ * That's only meaningful for a uniform image, the default (half gray).
+ * The first frame can be written as a binary PPM, auto-exposed to its
+ * brightest pixel.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "host.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+
+/** Camera settings, all times in nanoseconds. */
+typedef struct {
+  uint64_t lineNs;     ///< Rolling shutter line time, row to row
+  uint64_t exposureNs; ///< Exposure time of each row
+  uint64_t frameNs;    ///< Frame period (1 / frame rate)
+  uint64_t startNs;    ///< First frame start, from end of warm-up
+  uint16_t rows;       ///< Sensor rows covering the matrix
+  uint16_t frames;     ///< Frames to capture
+} camera;
+
+// Index of the first recorded span ending after time t.
+static uint32_t first_span(uint64_t t) {
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint32_t lo = 0, hi = log->numSpans;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (log->spans[mid].end <= t) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Expose one frame starting at t0: each sensor row r integrates the
+// light of matrix row (r * height / rows) over its window, in ns per LED.
+static void expose(double *frame, const camera *cam, uint64_t t0) {
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  memset(frame, 0, cam->rows * log->width * 3 * sizeof(double));
+  for (uint16_t r = 0; r < cam->rows; r++) {
+    uint16_t y = (uint32_t)r * log->height / cam->rows;
+    uint64_t start = t0 + r * cam->lineNs, end = start + cam->exposureNs;
+    double *row = &frame[r * log->width * 3];
+    for (uint32_t i = first_span(start);
+         (i < log->numSpans) && (log->spans[i].start < end); i++) {
+      const _PM_hostSpan *span = &log->spans[i];
+      uint64_t s = (span->start > start) ? span->start : start;
+      uint64_t e = (span->end < end) ? span->end : end;
+      for (uint16_t x = 0; x < log->width; x++) {
+        uint8_t lit = _PM_hostLit(span, x, y);
+        for (uint8_t c = 0; c < 3; c++) {
+          if (lit & (1 << c)) {
+            row[x * 3 + c] += e - s;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Standard deviation of sensor rows' mean levels over their mean.
+static double banding(const double *frame, uint16_t rows, uint16_t width) {
+  double sum = 0, sum2 = 0;
+  for (uint16_t r = 0; r < rows; r++) {
+    double mean = 0;
+    for (uint32_t i = 0; i < width * 3; i++) {
+      mean += frame[r * width * 3 + i];
+    }
+    mean /= width * 3;
+    sum += mean;
+    sum2 += mean * mean;
+  }
+  double mean = sum / rows;
+  if (mean <= 0) {
+    return 0;
+  }
+  double var = sum2 / rows - mean * mean;
+  return sqrt((var > 0) ? var : 0) / mean;
+}
+
+static int write_ppm(const char *name, const double *frame, uint16_t rows,
+                     uint16_t width) {
+  FILE *fp = fopen(name, "wb");
+  if (!fp) {
+    perror(name);
+    return 1;
+  }
+  double max = 0;
+  for (uint32_t i = 0; i < (uint32_t)rows * width * 3; i++) {
+    max = (frame[i] > max) ? frame[i] : max;
+  }
+  fprintf(fp, "P6\n%u %u\n255\n", width, rows);
+  for (uint32_t i = 0; i < (uint32_t)rows * width * 3; i++) {
+    fputc(max ? (int)(frame[i] * 255 / max + 0.5) : 0, fp);
+  }
+  return fclose(fp) ? 1 : 0;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-w width] [-d depth] [-a addrLines] [-c 565color]\n"
+          "       [-l lineUs] [-e exposureUs] [-f fps] [-s startUs]\n"
+          "       [-r sensorRows] [-n frames] [-o out.ppm] [-i]\n"
+          "Defaults: 64 wide, depth 6, 4 address lines (32 rows), color\n"
+          "0x8410 (half gray); 30 us line time, 2000 us exposure, 30 fps,\n"
+          "one sensor row per matrix row, 8 frames. -i enables coalescing.\n",
+          name);
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t width = 64, color = 0x8410;
+  uint8_t depth = 6, addrLines = 4;
+  camera cam = {30000, 2000000, 0, 0, 0, 8};
+  uint32_t fps = 30;
+  const char *out = NULL;
+  bool coalesce = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:d:a:c:l:e:f:s:r:n:o:i")) != -1) {
+    switch (opt) {
+    case 'w':
+      width = strtoul(optarg, NULL, 0);
+      break;
+    case 'd':
+      depth = strtoul(optarg, NULL, 0);
+      break;
+    case 'a':
+      addrLines = strtoul(optarg, NULL, 0);
+      break;
+    case 'c':
+      color = strtoul(optarg, NULL, 0);
+      break;
+    case 'l':
+      cam.lineNs = strtod(optarg, NULL) * 1000;
+      break;
+    case 'e':
+      cam.exposureNs = strtod(optarg, NULL) * 1000;
+      break;
+    case 'f':
+      fps = strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      cam.startNs = strtod(optarg, NULL) * 1000;
+      break;
+    case 'r':
+      cam.rows = strtoul(optarg, NULL, 0);
+      break;
+    case 'n':
+      cam.frames = strtoul(optarg, NULL, 0);
+      break;
+    case 'o':
+      out = optarg;
+      break;
+    case 'i':
+      coalesce = true;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (!depth || (depth > 6) || (addrLines < 1) || (addrLines > 5) ||
+      !fps || !cam.exposureNs || !cam.frames) {
+    usage(argv[0]);
+    return 2;
+  }
+  cam.frameNs = 1000000000ull / fps;
+
+  Protomatter_core core;
+  _PM_hostReset();
+  ProtomatterStatus status =
+      _PM_hostBegin(&core, width, depth, 1, addrLines, false);
+  if (status != PROTOMATTER_OK) {
+    fprintf(stderr, "begin failed (%d)\n", status);
+    return 1;
+  }
+  _PM_setCoalescing(&core, coalesce);
+  uint16_t height = 2 << addrLines;
+  if (!cam.rows) {
+    cam.rows = height;
+  }
+  uint16_t *canvas = malloc(width * height * sizeof(uint16_t));
+  double *frame = malloc(cam.rows * width * 3 * sizeof(double));
+  if (!canvas || !frame) {
+    _PM_free(&core);
+    return 1;
+  }
+  for (uint32_t i = 0; i < (uint32_t)width * height; i++) {
+    canvas[i] = color;
+  }
+  _PM_convert_565(&core, canvas, width);
+
+  _PM_hostRun(&core, 100000000); // Plane timing settles in 100 ms
+  (void)_PM_getFrameCount(&core);
+  uint64_t t0 = _PM_hostNow() + cam.startNs;
+  uint64_t span = cam.startNs + (cam.frames - 1) * cam.frameNs +
+                  (cam.rows - 1) * cam.lineNs + cam.exposureNs;
+  _PM_hostRecord(true);
+  _PM_hostRun(&core, span);
+  _PM_hostRecord(false);
+  double hz = _PM_getFrameCount(&core) * 1e9 / span;
+
+  printf("refresh %.1f Hz, %u sensor rows, line %.1f us, exposure %.1f "
+         "us, %u fps\nframe banding\n",
+         hz, cam.rows, cam.lineNs / 1e3, cam.exposureNs / 1e3, fps);
+  double total = 0, worst = 0;
+  int err = 0;
+  for (uint16_t f = 0; f < cam.frames; f++) {
+    expose(frame, &cam, t0 + f * cam.frameNs);
+    double b = banding(frame, cam.rows, width);
+    printf("%5u %7.4f\n", f, b);
+    total += b;
+    worst = (b > worst) ? b : worst;
+    if (!f && out) {
+      err |= write_ppm(out, frame, cam.rows, width);
+    }
+  }
+  printf("mean %.4f, worst %.4f\n", total / cam.frames, worst);
+  free(canvas);
+  free(frame);
+  _PM_free(&core);
+  return err;
+}
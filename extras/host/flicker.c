@@ -0,0 +1,257 @@
+/*!
+ * @file flicker.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Photometric flicker analysis of the refresh schedule, on the emulated
+ * matrix (see host.h). One LED's light output is sampled over a window of
+ * virtual time and the usual flicker metrics reported:
+ *
+ * - Percent flicker: 100 * (max - min) / (max + min) of the waveform.
+ * - Flicker index: area of the waveform above its mean, over total area
+ *   (0 for steady light, approaching 1 for short pulses).
+ * - Dominant frequency: strongest non-DC component of its spectrum.
+ *
+ * Sampled at 1 us, the waveform of any LED on a scanned matrix is a pulse
+ * train, so percent flicker is 100 unless the detector is given a sample
+ * time (-r) approaching the refresh period; flicker index and dominant
+ * frequency are the telling ones. Mean output is relative to an LED lit
+ * continuously. By default a table of bit depths and chain widths is
+ * run; options narrow it down.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "host.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+
+#define SAMPLES (1 << 18) ///< Waveform length, power of two for the FFT
+
+/** Flicker metrics for one LED. */
+typedef struct {
+  double percent;  ///< Percent flicker
+  double index;    ///< Flicker index
+  double dominant; ///< Dominant frequency, Hz
+  double mean;     ///< Mean output, 0-1
+} metrics;
+
+// In-place radix-2 FFT, n a power of two.
+static void fft(double *re, double *im, uint32_t n) {
+  for (uint32_t i = 1, j = 0; i < n; i++) {
+    uint32_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      double t = re[i];
+      re[i] = re[j];
+      re[j] = t;
+      t = im[i];
+      im[i] = im[j];
+      im[j] = t;
+    }
+  }
+  for (uint32_t len = 2; len <= n; len <<= 1) {
+    double a = -2 * M_PI / len;
+    for (uint32_t i = 0; i < n; i += len) {
+      for (uint32_t k = 0; k < len / 2; k++) {
+        double wr = cos(a * k), wi = sin(a * k);
+        double *ur = &re[i + k], *ui = &im[i + k];
+        double *vr = &re[i + k + len / 2], *vi = &im[i + k + len / 2];
+        double xr = *vr * wr - *vi * wi, xi = *vr * wi + *vi * wr;
+        *vr = *ur - xr;
+        *vi = *ui - xi;
+        *ur += xr;
+        *ui += xi;
+      }
+    }
+  }
+}
+
+// Light output of one LED (c = 0, 1, 2 for R, G, B) from the recorded
+// spans, as the fraction of each sample period it was on.
+static void waveform(double *wave, uint64_t t0, uint32_t sampleNs,
+                     uint16_t x, uint16_t y, uint8_t c) {
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint64_t t1 = t0 + (uint64_t)SAMPLES * sampleNs;
+  memset(wave, 0, SAMPLES * sizeof(double));
+  for (uint32_t i = 0; i < log->numSpans; i++) {
+    const _PM_hostSpan *span = &log->spans[i];
+    if (!(_PM_hostLit(span, x, y) & (1 << c))) {
+      continue;
+    }
+    uint64_t start = (span->start > t0) ? span->start : t0;
+    uint64_t end = (span->end < t1) ? span->end : t1;
+    while (start < end) {
+      uint32_t s = (start - t0) / sampleNs;
+      uint64_t edge = t0 + (uint64_t)(s + 1) * sampleNs;
+      uint64_t stop = (edge < end) ? edge : end;
+      wave[s] += (double)(stop - start) / sampleNs;
+      start = stop;
+    }
+  }
+}
+
+static metrics measure(const double *wave, uint32_t sampleNs) {
+  metrics m = {0, 0, 0, 0};
+  double lo = 1, hi = 0, sum = 0, above = 0;
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    lo = (wave[i] < lo) ? wave[i] : lo;
+    hi = (wave[i] > hi) ? wave[i] : hi;
+    sum += wave[i];
+  }
+  m.mean = sum / SAMPLES;
+  if (sum <= 0) {
+    return m; // Dark, no flicker to speak of
+  }
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    if (wave[i] > m.mean) {
+      above += wave[i] - m.mean;
+    }
+  }
+  m.percent = 100 * (hi - lo) / (hi + lo);
+  m.index = above / sum;
+
+  double *re = malloc(SAMPLES * sizeof(double));
+  double *im = calloc(SAMPLES, sizeof(double));
+  if (re && im) {
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+      re[i] = wave[i] - m.mean;
+    }
+    fft(re, im, SAMPLES);
+    double best = 0;
+    for (uint32_t k = 1; k < SAMPLES / 2; k++) {
+      double p = re[k] * re[k] + im[k] * im[k];
+      if (p > best) {
+        best = p;
+        m.dominant = k * 1e9 / ((double)SAMPLES * sampleNs);
+      }
+    }
+  }
+  free(re);
+  free(im);
+  return m;
+}
+
+// Run one configuration; returns 0 on success.
+static int run(uint16_t width, uint8_t depth, uint8_t addrLines,
+               uint16_t color, uint16_t x, uint16_t y, uint8_t c,
+               uint32_t sampleNs, bool coalesce, double *wave) {
+  Protomatter_core core;
+  _PM_hostReset();
+  ProtomatterStatus status =
+      _PM_hostBegin(&core, width, depth, 1, addrLines, false);
+  if (status != PROTOMATTER_OK) {
+    fprintf(stderr, "width %u depth %u: begin failed (%d)\n", width, depth,
+            status);
+    return 1;
+  }
+  _PM_setCoalescing(&core, coalesce);
+  uint16_t height = 2 << addrLines;
+  uint16_t *canvas = malloc(width * height * sizeof(uint16_t));
+  if (!canvas) {
+    _PM_free(&core);
+    return 1;
+  }
+  for (uint32_t i = 0; i < (uint32_t)width * height; i++) {
+    canvas[i] = color;
+  }
+  _PM_convert_565(&core, canvas, width);
+  free(canvas);
+
+  _PM_hostRun(&core, 100000000); // Plane timing settles in 100 ms
+  (void)_PM_getFrameCount(&core);
+  uint64_t t0 = _PM_hostNow();
+  _PM_hostRecord(true);
+  _PM_hostRun(&core, (uint64_t)SAMPLES * sampleNs);
+  _PM_hostRecord(false);
+  double hz = _PM_getFrameCount(&core) * 1e9 / (_PM_hostNow() - t0);
+
+  waveform(wave, t0, sampleNs, x, y, c);
+  metrics m = measure(wave, sampleNs);
+  printf("%5u %5u %5u %9.1f %8.4f %8.1f %8.4f %10.1f\n", width, height,
+         depth, hz, m.mean, m.percent, m.index, m.dominant);
+  _PM_free(&core);
+  return 0;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-w width] [-d depth] [-a addrLines] [-c 565color]\n"
+          "       [-x x] [-y y] [-l 0|1|2 (R|G|B)] [-r sampleUs] [-i]\n"
+          "-w and -d default to a sweep of 32-256 and 1-6; -c to 0x8410\n"
+          "(half gray), -a to 4 (32 rows); -i enables coalescing.\n",
+          name);
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t widths[] = {32, 64, 128, 256}, width = 0;
+  uint8_t depth = 0, addrLines = 4, led = 1;
+  uint16_t color = 0x8410, x = 0, y = 0;
+  uint32_t sampleNs = 1000;
+  bool coalesce = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:d:a:c:x:y:l:r:i")) != -1) {
+    switch (opt) {
+    case 'w':
+      width = strtoul(optarg, NULL, 0);
+      break;
+    case 'd':
+      depth = strtoul(optarg, NULL, 0);
+      break;
+    case 'a':
+      addrLines = strtoul(optarg, NULL, 0);
+      break;
+    case 'c':
+      color = strtoul(optarg, NULL, 0);
+      break;
+    case 'x':
+      x = strtoul(optarg, NULL, 0);
+      break;
+    case 'y':
+      y = strtoul(optarg, NULL, 0);
+      break;
+    case 'l':
+      led = strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      sampleNs = strtoul(optarg, NULL, 0) * 1000;
+      break;
+    case 'i':
+      coalesce = true;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if ((depth > 6) || (addrLines < 1) || (addrLines > 5) || (led > 2) ||
+      !sampleNs) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  double *wave = malloc(SAMPLES * sizeof(double));
+  if (!wave) {
+    return 1;
+  }
+  printf("width height depth refreshHz     mean flicker%% flickIdx "
+         "dominantHz\n");
+  int err = 0;
+  for (uint8_t w = 0; w < 4; w++) {
+    uint16_t wd = width ? width : widths[w];
+    for (uint8_t d = depth ? depth : 1; d <= (depth ? depth : 6); d++) {
+      err |= run(wd, d, addrLines, color, x, y, led, sampleNs, coalesce,
+                 wave);
+    }
+    if (width) {
+      break;
+    }
+  }
+  free(wave);
+  return err;
+}
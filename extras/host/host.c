@@ -0,0 +1,453 @@
+/*!
+ * @file host.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Host simulation of GPIO, timer and matrix, see host.h.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "host.h"
+
+_PM_hostPort _PM_hostPorts[_PM_HOST_PORTS];
+_PM_hostTimer _PM_hostTimer0;
+_PM_hostCost _PM_hostCosts = {4, 8, 150};
+_PM_hostLog _PM_hostMatrix;
+
+#define TICK_NS (1000000000 / _PM_HOST_TIMER_FREQ) ///< Virtual ns per tick
+#define PORT(pin) ((pin) / _PM_HOST_PORT_BITS)         ///< Pin's PORT index
+#define BIT(pin) (1u << ((pin) % _PM_HOST_PORT_BITS))  ///< Pin's PORT bit
+
+static uint64_t now;                   // Virtual time, ns
+static uint32_t state[_PM_HOST_PORTS]; // PORT outputs as of last sync
+
+// The attached matrix: pins it's wired to, its shift registers (a ring,
+// head being the element clocked in longest ago) and output latches, and
+// the span being recorded.
+static struct {
+  uint8_t rgbPins[30];
+  uint8_t addrPins[5];
+  uint8_t numRGB;
+  uint8_t numAddr;
+  uint8_t clockPin;
+  uint8_t latchPin;
+  uint8_t oePin;
+  uint16_t head;
+  uint32_t *shift;
+  uint32_t *latched;
+  uint32_t bits; // Index of latched data in _PM_hostMatrix.bits
+  uint64_t spanStart;
+  uint8_t row;
+  bool lit;
+  bool attached;
+} panel;
+
+static bool level(uint8_t pin) {
+  return (state[PORT(pin)] & BIT(pin)) != 0;
+}
+
+// Append latched data to the log, return its index.
+static uint32_t log_bits(void) {
+  _PM_hostLog *log = &_PM_hostMatrix;
+  if (log->numBits + log->width > log->maxBits) {
+    uint32_t max = log->maxBits ? log->maxBits * 2 : log->width * 1024;
+    uint32_t *bits = (uint32_t *)realloc(log->bits, max * sizeof(uint32_t));
+    if (!bits) {
+      abort(); // Host tools only, nothing sensible to carry on with
+    }
+    log->bits = bits;
+    log->maxBits = max;
+  }
+  uint32_t index = log->numBits;
+  memcpy(&log->bits[index], panel.latched, log->width * sizeof(uint32_t));
+  log->numBits += log->width;
+  return index;
+}
+
+// Close the span in progress (if output was on), start the next.
+static void log_span(void) {
+  _PM_hostLog *log = &_PM_hostMatrix;
+  if (log->enabled && panel.lit && (now > panel.spanStart)) {
+    if (log->numSpans >= log->maxSpans) {
+      uint32_t max = log->maxSpans ? log->maxSpans * 2 : 4096;
+      _PM_hostSpan *spans =
+          (_PM_hostSpan *)realloc(log->spans, max * sizeof(_PM_hostSpan));
+      if (!spans) {
+        abort();
+      }
+      log->spans = spans;
+      log->maxSpans = max;
+    }
+    _PM_hostSpan *span = &log->spans[log->numSpans++];
+    span->start = panel.spanStart;
+    span->end = now;
+    span->bits = panel.bits;
+    span->row = panel.row;
+  }
+  panel.spanStart = now;
+}
+
+// Matrix reacts to PORT changes: clock shifts RGB data in, latch copies it
+// to the outputs, OE (active low) and address lines select what's lit.
+static void panel_update(const uint32_t *before) {
+  uint8_t p = PORT(panel.clockPin);
+  uint32_t clock = BIT(panel.clockPin);
+  if (!(before[p] & clock) && (state[p] & clock)) {
+    uint32_t bits = 0;
+    for (uint8_t i = 0; i < panel.numRGB; i++) {
+      bits |= (uint32_t)level(panel.rgbPins[i]) << i;
+    }
+    panel.shift[panel.head] = bits;
+    if (++panel.head >= _PM_hostMatrix.width) {
+      panel.head = 0;
+    }
+  }
+
+  bool latch = false;
+  p = PORT(panel.latchPin);
+  uint32_t bit = BIT(panel.latchPin);
+  if (!(before[p] & bit) && (state[p] & bit)) {
+    uint16_t width = _PM_hostMatrix.width;
+    for (uint16_t x = 0; x < width; x++) {
+      panel.latched[x] = panel.shift[(panel.head + x) % width];
+    }
+    latch = true;
+  }
+
+  uint8_t row = 0;
+  for (uint8_t line = 0; line < panel.numAddr; line++) {
+    row |= level(panel.addrPins[line]) << line;
+  }
+  bool lit = !level(panel.oePin);
+  if (latch || (lit != panel.lit) || (row != panel.row)) {
+    log_span();
+    if (latch && _PM_hostMatrix.enabled) {
+      panel.bits = log_bits();
+    }
+    panel.lit = lit;
+    panel.row = row;
+  }
+}
+
+// EMULATED GPIO -----------------------------------------------------------
+
+// Apply register writes since the last sync. A changed OUT register is a
+// direct write, otherwise clear, set, toggle; or for 16-bit PORTs, BSRR
+// clear and set bits.
+void _PM_hostSync(void) {
+  uint32_t before[_PM_HOST_PORTS];
+  bool changed = false;
+  for (uint8_t p = 0; p < _PM_HOST_PORTS; p++) {
+    _PM_hostPort *port = &_PM_hostPorts[p];
+    uint32_t out = before[p] = state[p];
+    if (port->out != out) {
+      out = port->out;
+    }
+#if defined(_PM_HOST_SET_CLEAR_COMBINED)
+    out &= ~(port->set >> 16);
+    out |= port->set & 0xFFFF;
+#else
+    out &= ~port->clr;
+    out |= port->set;
+    out ^= port->tgl;
+#endif
+    port->clr = port->set = port->tgl = 0;
+    port->dir |= port->dirset;
+    port->dirset = 0;
+    port->out = state[p] = out;
+    changed |= (out != before[p]);
+  }
+  if (changed && panel.attached) {
+    panel_update(before);
+  }
+}
+
+// One RGB data or clock PORT write, see _PM_clockHoldLow in arch.h.
+void _PM_hostWrite(void) {
+  _PM_hostSync();
+  now += _PM_hostCosts.writeNs;
+}
+
+void _PM_hostPinOutput(uint8_t pin) {
+  _PM_hostPorts[PORT(pin)].dir |= BIT(pin);
+}
+
+void _PM_hostPinInput(uint8_t pin) {
+  _PM_hostPorts[PORT(pin)].dir &= ~BIT(pin);
+}
+
+void _PM_hostPinHigh(uint8_t pin) {
+  _PM_hostSync();
+  _PM_hostPorts[PORT(pin)].set = BIT(pin);
+  _PM_hostSync();
+}
+
+void _PM_hostPinLow(uint8_t pin) {
+  _PM_hostSync();
+#if defined(_PM_HOST_SET_CLEAR_COMBINED)
+  _PM_hostPorts[PORT(pin)].set = BIT(pin) << 16;
+#else
+  _PM_hostPorts[PORT(pin)].clr = BIT(pin);
+#endif
+  _PM_hostSync();
+}
+
+void _PM_hostDelay(uint32_t us) {
+  _PM_hostSync();
+  now += (uint64_t)us * 1000;
+}
+
+// EMULATED TIMER ----------------------------------------------------------
+
+// Counts up from zero at _PM_HOST_TIMER_FREQ until stopped, "interrupting"
+// (see _PM_hostInterrupt()) once it reaches its period. Like the SAMD
+// timers (MFRQ mode) and other auto-reload timers, the count then restarts
+// from zero; with _PM_HOST_TIMER_NO_WRAP it carries on, as on nRF52.
+
+// Ticks since the timer started, wrapped at its period
+static uint32_t count(const _PM_hostTimer *timer) {
+  uint32_t ticks = (now - timer->start) / TICK_NS;
+#if !defined(_PM_HOST_TIMER_NO_WRAP)
+  if (timer->period) {
+    ticks %= timer->period;
+  }
+#endif
+  return ticks;
+}
+
+void _PM_hostTimerInit(void *tptr) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)tptr;
+  timer->running = false;
+}
+
+void _PM_hostTimerStart(void *tptr, uint32_t period) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)tptr;
+  _PM_hostSync();
+  timer->start = now;
+  timer->period = period;
+  timer->running = true;
+}
+
+uint32_t _PM_hostTimerGetCount(void *tptr) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)tptr;
+  _PM_hostSync();
+  now += _PM_hostCosts.readNs; // Also keeps polling loops moving
+  return count(timer);
+}
+
+uint32_t _PM_hostTimerStop(void *tptr) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)tptr;
+  _PM_hostSync();
+  timer->running = false;
+  return count(timer);
+}
+
+// VIRTUAL TIME ------------------------------------------------------------
+
+uint64_t _PM_hostNow(void) { return now; }
+
+// Take the timer interrupt: advance to the timer's expiry (if not there
+// already, e.g. the last handler ran long), plus entry time, and run the
+// row handler. Returns false if the timer isn't running (refresh stopped
+// or paused), in which case nothing will ever happen.
+bool _PM_hostInterrupt(Protomatter_core *core) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)core->timer;
+  if (!timer->running) {
+    return false;
+  }
+  uint64_t expiry = timer->start + (uint64_t)timer->period * TICK_NS;
+  if (now < expiry) {
+    now = expiry;
+  }
+  now += _PM_hostCosts.entryNs;
+  _PM_row_handler(core);
+  return true;
+}
+
+// Run matrix refresh for some span of virtual time, returning the number
+// of row handler calls. Stops at the last interrupt due within the span;
+// virtual time is then advanced to its end.
+uint32_t _PM_hostRun(Protomatter_core *core, uint64_t ns) {
+  _PM_hostTimer *timer = (_PM_hostTimer *)core->timer;
+  uint64_t end = now + ns;
+  uint32_t calls = 0;
+  while (timer->running &&
+         (timer->start + (uint64_t)timer->period * TICK_NS < end)) {
+    _PM_hostInterrupt(core);
+    calls++;
+  }
+  if (now < end) {
+    _PM_hostSync();
+    now = end;
+  }
+  return calls;
+}
+
+// Back to time zero, all PORTs low, nothing attached or recorded.
+void _PM_hostReset(void) {
+  _PM_hostClear();
+  free(panel.shift);
+  free(panel.latched);
+  memset(&panel, 0, sizeof panel);
+  memset(_PM_hostPorts, 0, sizeof _PM_hostPorts);
+  memset(state, 0, sizeof state);
+  memset(&_PM_hostTimer0, 0, sizeof _PM_hostTimer0);
+  now = 0;
+}
+
+// EMULATED MATRIX ---------------------------------------------------------
+
+// Wire up a matrix to the core's pins, sized to match (call after
+// _PM_begin()). Address lines give the row pairs per
+// chain, so a core using fewer than the matrix has is a mismatch here,
+// as it would be on hardware.
+bool _PM_hostAttach(Protomatter_core *core) {
+  if (!core || !core->screenData) {
+    return false;
+  }
+  _PM_hostLog *log = &_PM_hostMatrix;
+  _PM_hostClear();
+  free(panel.shift);
+  free(panel.latched);
+  memset(&panel, 0, sizeof panel);
+  log->width = core->width << core->doubleColumns;
+  log->rowPairs = 1 << core->numAddressLines;
+  log->height = log->rowPairs * 2 * core->parallel;
+  panel.shift = (uint32_t *)calloc(log->width, sizeof(uint32_t));
+  panel.latched = (uint32_t *)calloc(log->width, sizeof(uint32_t));
+  if (!panel.shift || !panel.latched) {
+    return false;
+  }
+  panel.numRGB = core->parallel * 6;
+  memcpy(panel.rgbPins, core->rgbPins, panel.numRGB);
+  panel.numAddr = core->numAddressLines;
+  for (uint8_t line = 0; line < panel.numAddr; line++) {
+    panel.addrPins[line] = core->addr[line].pin;
+  }
+  panel.clockPin = core->clockPin;
+  panel.latchPin = core->latch.pin;
+  panel.oePin = core->oe.pin;
+  _PM_hostSync();
+  panel.lit = !level(panel.oePin);
+  panel.spanStart = now;
+  panel.attached = true;
+  return true;
+}
+
+// Everything on the suggested pins, see host.h.
+ProtomatterStatus _PM_hostBegin(Protomatter_core *core, uint16_t width,
+                                uint8_t depth, uint8_t chains,
+                                uint8_t addrLines, bool doubleBuffer) {
+  return _PM_hostBeginClock(core, width, depth, chains, addrLines,
+                            doubleBuffer, _PM_HOST_CLOCK);
+}
+
+ProtomatterStatus _PM_hostBeginClock(Protomatter_core *core, uint16_t width,
+                                     uint8_t depth, uint8_t chains,
+                                     uint8_t addrLines, bool doubleBuffer,
+                                     uint8_t clockPin) {
+  ProtomatterStatus status = _PM_hostInit(core, width, depth, chains,
+                                          addrLines, doubleBuffer, clockPin);
+  return (status == PROTOMATTER_OK) ? _PM_hostStart(core) : status;
+}
+
+ProtomatterStatus _PM_hostInit(Protomatter_core *core, uint16_t width,
+                               uint8_t depth, uint8_t chains,
+                               uint8_t addrLines, bool doubleBuffer,
+                               uint8_t clockPin) {
+  uint8_t rgbPins[30], addrPins[5];
+  for (uint8_t i = 0; i < 30; i++) {
+    rgbPins[i] = _PM_HOST_RGB(i);
+  }
+  for (uint8_t i = 0; i < 5; i++) {
+    addrPins[i] = _PM_HOST_ADDR + _PM_HOST_ADDR_STEP * i;
+  }
+  return _PM_init(core, width, depth, chains, rgbPins, addrLines, addrPins,
+                  clockPin, _PM_HOST_LATCH, _PM_HOST_OE, doubleBuffer, NULL);
+}
+
+// The core's own errors are passed along; a core that won't start is
+// freed here.
+ProtomatterStatus _PM_hostStart(Protomatter_core *core) {
+  ProtomatterStatus status = _PM_begin(core);
+  if ((status == PROTOMATTER_OK) && !_PM_hostAttach(core)) {
+    status = PROTOMATTER_ERR_MALLOC;
+  }
+  if (status != PROTOMATTER_OK) {
+    _PM_free(core);
+  }
+  return status;
+}
+
+// Start or stop recording matrix output spans. Data latched before the
+// start is logged as the first entry so the span in progress has it.
+void _PM_hostRecord(bool enable) {
+  _PM_hostLog *log = &_PM_hostMatrix;
+  _PM_hostSync();
+  if (enable && !log->enabled) {
+    log->enabled = true;
+    panel.bits = log_bits();
+    panel.spanStart = now;
+  } else if (!enable && log->enabled) {
+    log_span();
+    log->enabled = false;
+  }
+}
+
+// Discard recorded output (recording state is unchanged).
+void _PM_hostClear(void) {
+  _PM_hostLog *log = &_PM_hostMatrix;
+  bool enabled = log->enabled;
+  log->numSpans = log->numBits = 0;
+  log->enabled = false;
+  if (enabled && panel.attached) {
+    _PM_hostRecord(true);
+  }
+}
+
+// Which of a pixel's red, green and blue LEDs (bits 0, 1, 2) a span lit.
+// The six RGB pins of each chain are R1, G1, B1 (upper half of the
+// matrix) then R2, G2, B2 (lower half), chains stacked top to bottom.
+uint8_t _PM_hostLit(const _PM_hostSpan *span, uint16_t x, uint16_t y) {
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint8_t rows = log->rowPairs;
+  if ((x >= log->width) || (y >= log->height) || (span->row != y % rows)) {
+    return 0;
+  }
+  uint8_t shift = (y / (rows * 2)) * 6 + ((y / rows) & 1) * 3;
+  return (log->bits[span->bits + x] >> shift) & 7;
+}
+
+// Perceived (time-averaged) image from the recorded output: each LED's
+// on time as a fraction of the time its row was lit at all, i.e. 1.0 is
+// as bright as that LED gets. Three values (R, G, B) per pixel.
+void _PM_hostImage(double *image) {
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint64_t rowTime[32] = {0};
+  uint32_t pixels = (uint32_t)log->width * log->height;
+  memset(image, 0, pixels * 3 * sizeof(double));
+  for (uint32_t i = 0; i < log->numSpans; i++) {
+    const _PM_hostSpan *span = &log->spans[i];
+    uint64_t t = span->end - span->start;
+    rowTime[span->row] += t;
+    for (uint16_t y = span->row; y < log->height; y += log->rowPairs) {
+      double *rgb = &image[y * log->width * 3];
+      for (uint16_t x = 0; x < log->width; x++, rgb += 3) {
+        uint8_t lit = _PM_hostLit(span, x, y);
+        for (uint8_t c = 0; c < 3; c++) {
+          if (lit & (1 << c)) {
+            rgb[c] += t;
+          }
+        }
+      }
+    }
+  }
+  for (uint32_t i = 0; i < pixels * 3; i++) {
+    uint64_t t = rowTime[(i / 3 / log->width) % log->rowPairs];
+    if (t) {
+      image[i] /= t;
+    }
+  }
+}
@@ -0,0 +1,348 @@
+/*!
+ * @file host.h
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Host (e.g. Linux) simulation: emulated GPIO PORTs, timer and matrix, all
+ * running in virtual time, so core.c can be built and run on a desktop
+ * machine for tests and analysis tools. Compile core.c with -D_PM_HOST
+ * (arch.h then pulls in this file) and link with host.c; see the Makefile
+ * in this directory.
+ *
+ * Nothing runs on its own here. The timer "interrupt" is whenever the
+ * caller says so: _PM_hostRun() advances virtual time, calling the row
+ * handler at each point the timer would expire, so a second of refresh
+ * takes milliseconds and every run is exactly repeatable.
+ *
+ * PORTs are 32 bits with separate set, clear and toggle registers, as on
+ * SAMD. -D_PM_HOST_NO_TOGGLE drops the toggle register (as nRF52), and
+ * -D_PM_HOST_SET_CLEAR_COMBINED makes them 16 bits with STM32-style BSRR
+ * semantics (see _PM_hostPort), so each of the core's encodings can be run.
+ * The timer's count restarts from zero at its period, as SAMD's (MFRQ
+ * mode) and other auto-reload timers do; -D_PM_HOST_TIMER_NO_WRAP has it
+ * carry on instead, as nRF52's does.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef _PROTOMATTER_HOST_H_
+#define _PROTOMATTER_HOST_H_
+
+#include "../../core.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_PM_HOST_SET_CLEAR_COMBINED)
+#define _PM_HOST_PORT_BITS 16 ///< PORT width; pin n is bit n % 16 of n / 16
+#else
+#define _PM_HOST_PORT_BITS 32 ///< PORT width; pin n is bit n % 32 of n / 32
+#endif
+#define _PM_HOST_PORTS 8             ///< Number of PORTs
+#define _PM_HOST_TIMER_FREQ 50000000 ///< Timer ticks/sec (20 ns, exactly)
+
+// Suggested pins: RGB data from PORT 0 bit 0 up (5 chains, or 2 with
+// 16-bit PORTs), clock at the top of PORT 0, latch, OE and address lines
+// each on a PORT of their own.
+#define _PM_HOST_CLOCK (_PM_HOST_PORT_BITS - 2) ///< Suggested clock pin
+#define _PM_HOST_LATCH _PM_HOST_PORT_BITS       ///< Suggested latch pin
+#define _PM_HOST_OE (_PM_HOST_PORT_BITS * 2)    ///< Suggested OE pin
+#define _PM_HOST_ADDR (_PM_HOST_PORT_BITS * 3)  ///< Suggested address pin 0
+#define _PM_HOST_ADDR_STEP _PM_HOST_PORT_BITS   ///< ...and per further line
+#define _PM_HOST_RGB(n) (n)                     ///< Suggested RGB pins
+
+/** One emulated GPIO PORT. Writes to set, clr, tgl and dirset take effect
+    at the next sync point (RGB data or clock write, pin call, timer call
+    or delay), in that order, so each may only be written once between
+    sync points. The core does so for RGB data and clock; latch, OE and
+    address lines should each be on a PORT of their own (as with the
+    suggested pins above) so their writes can't overlap. With
+    _PM_HOST_SET_CLEAR_COMBINED, set is a 32-bit BSRR: the low 16 bits
+    set pins and the high 16 clear them (set wins if both), and the clear
+    register is its upper half; clr is unused. */
+typedef struct {
+  volatile uint32_t out;    ///< Output state (also a direct OUT register)
+  volatile uint32_t set;    ///< Bit set register (or BSRR, see above)
+  volatile uint32_t clr;    ///< Bit clear register
+  volatile uint32_t tgl;    ///< Bit toggle register
+  volatile uint32_t dirset; ///< Direction set register
+  uint32_t dir;             ///< Pin directions, 1 = output
+} _PM_hostPort;
+
+/** Emulated timer/counter, see _PM_hostInterrupt(). */
+typedef struct {
+  uint64_t start;  ///< Virtual time (ns) of last start
+  uint32_t period; ///< Ticks to expiry
+  bool running;    ///< If 1, counting and will "interrupt"
+} _PM_hostTimer;
+
+/** Time the emulated device takes for things, in nanoseconds. Defaults
+    are roughly those of a 120 MHz Cortex-M4 with a toggle register. */
+typedef struct {
+  uint32_t writeNs; ///< Per RGB data or clock PORT write
+  uint32_t readNs;  ///< Per timer count read
+  uint32_t entryNs; ///< Interrupt entry, timer expiry to row handler
+} _PM_hostCost;
+
+/** One span of time for which the matrix output was enabled showing one
+    row pair, see _PM_hostRecord(). */
+typedef struct {
+  uint64_t start; ///< Output enabled (or span began), virtual time (ns)
+  uint64_t end;   ///< Output disabled (or row or data changed)
+  uint32_t bits;  ///< Index of latched column data in _PM_hostLog.bits
+  uint8_t row;    ///< Row pair (address lines)
+} _PM_hostSpan;
+
+/** Record of matrix output, see _PM_hostRecord(). */
+typedef struct {
+  _PM_hostSpan *spans; ///< Spans, in time order
+  uint32_t *bits;      ///< Latched data, width elements per latch
+  uint32_t numSpans;   ///< Spans recorded
+  uint32_t numBits;    ///< Elements used in bits[]
+  uint32_t maxSpans;   ///< Allocated size of spans[]
+  uint32_t maxBits;    ///< Allocated size of bits[]
+  uint16_t width;      ///< Matrix chain width in pixels
+  uint16_t height;     ///< Matrix height in pixels (all parallel chains)
+  uint8_t rowPairs;    ///< Row pairs per chain (from address lines)
+  bool enabled;        ///< If 1, spans are being recorded
+} _PM_hostLog;
+
+extern _PM_hostPort _PM_hostPorts[_PM_HOST_PORTS]; ///< Emulated PORTs
+extern _PM_hostTimer _PM_hostTimer0; ///< Timer used if core passes NULL
+extern _PM_hostCost _PM_hostCosts;   ///< Current costs, may be changed
+extern _PM_hostLog _PM_hostMatrix;   ///< Output of the attached matrix
+
+/*!
+  @brief  Apply emulated PORT register writes made since the last call,
+          and have the attached matrix (if any) react to them. Called
+          by everything below that touches time or pins; only needed
+          directly when writing _PM_hostPorts by hand.
+*/
+extern void _PM_hostSync(void);
+
+/*!
+  @brief  Sync, then advance virtual time by one PORT write. arch.h uses
+          this for _PM_clockHoldLow and _PM_clockHoldHigh, which follow
+          each RGB data and clock write.
+*/
+extern void _PM_hostWrite(void);
+
+/*!
+  @brief  Set a pin to output (arch.h _PM_pinOutput()).
+  @param  pin  Pin number.
+*/
+extern void _PM_hostPinOutput(uint8_t pin);
+
+/*!
+  @brief  Set a pin to input (arch.h _PM_pinInput()).
+  @param  pin  Pin number.
+*/
+extern void _PM_hostPinInput(uint8_t pin);
+
+/*!
+  @brief  Set an output pin high (arch.h _PM_pinHigh()).
+  @param  pin  Pin number.
+*/
+extern void _PM_hostPinHigh(uint8_t pin);
+
+/*!
+  @brief  Set an output pin low (arch.h _PM_pinLow()).
+  @param  pin  Pin number.
+*/
+extern void _PM_hostPinLow(uint8_t pin);
+
+/*!
+  @brief  Advance virtual time (arch.h _PM_delayMicroseconds()).
+  @param  us  Microseconds.
+*/
+extern void _PM_hostDelay(uint32_t us);
+
+/*!
+  @brief  Initialize, but do not start, an emulated timer.
+  @param  tptr  Pointer to _PM_hostTimer.
+*/
+extern void _PM_hostTimerInit(void *tptr);
+
+/*!
+  @brief  (Re)start an emulated timer from zero.
+  @param  tptr    Pointer to _PM_hostTimer.
+  @param  period  Ticks until it "interrupts" (see _PM_hostInterrupt()).
+*/
+extern void _PM_hostTimerStart(void *tptr, uint32_t period);
+
+/*!
+  @brief  Read an emulated timer's count. Each read costs virtual time
+          (_PM_hostCosts.readNs), so loops polling it make progress.
+  @param  tptr  Pointer to _PM_hostTimer.
+  @return Ticks since it was started, modulo its period (unless
+          _PM_HOST_TIMER_NO_WRAP is defined).
+*/
+extern uint32_t _PM_hostTimerGetCount(void *tptr);
+
+/*!
+  @brief  Stop an emulated timer.
+  @param  tptr  Pointer to _PM_hostTimer.
+  @return Ticks since it was started, as _PM_hostTimerGetCount().
+*/
+extern uint32_t _PM_hostTimerStop(void *tptr);
+
+/*!
+  @brief  Get current virtual time.
+  @return Nanoseconds since _PM_hostReset() (or program start).
+*/
+extern uint64_t _PM_hostNow(void);
+
+/*!
+  @brief  Take one timer interrupt: advance virtual time to the running
+          timer's expiry (if not already past it) plus interrupt entry
+          time, and call the row handler. arch.h uses this for
+          _PM_vblankWait(), so anything waiting on the row handler (e.g.
+          a double-buffered swap) proceeds.
+  @param  core  Pointer to Protomatter_core structure.
+  @return true if the handler ran, false if the timer isn't running
+          (refresh stopped or paused), in which case it never will.
+*/
+extern bool _PM_hostInterrupt(Protomatter_core *core);
+
+/*!
+  @brief  Run matrix refresh for a span of virtual time: take each timer
+          interrupt due within it, then advance to its end.
+  @param  core  Pointer to Protomatter_core structure.
+  @param  ns    Nanoseconds to run.
+  @return Number of row handler calls.
+*/
+extern uint32_t _PM_hostRun(Protomatter_core *core, uint64_t ns);
+
+/*!
+  @brief  Reset the simulation: virtual time zero, all PORTs low, no
+          matrix attached, nothing recorded. Call between independent
+          runs (after _PM_free() of any core using it).
+*/
+extern void _PM_hostReset(void);
+
+/*!
+  @brief  Wire an emulated matrix to a core's pins, sized to match. Call
+          after _PM_begin() (and _PM_setPixelDoubling(), if used, as the
+          matrix is then twice the stored width). Only one matrix is
+          attached at a time.
+  @param  core  Pointer to Protomatter_core structure.
+  @return true on success, false if the core isn't started or on
+          allocation failure.
+*/
+extern bool _PM_hostAttach(Protomatter_core *core);
+
+/*!
+  @brief  Initialize and start a core on the suggested pins (RGB data on
+          _PM_HOST_RGB(0) up, clock, latch and OE on _PM_HOST_CLOCK etc.,
+          address lines from _PM_HOST_ADDR) with the default timer, and
+          attach the emulated matrix to it.
+  @param  core          Pointer to Protomatter_core structure.
+  @param  width         Matrix chain width in pixels.
+  @param  depth         Bitplanes (1-6).
+  @param  chains        Parallel matrix chains (1-5, or 1-2 with 16-bit
+                        PORTs).
+  @param  addrLines     Address lines (row pairs = 2^addrLines).
+  @param  doubleBuffer  If true, double-buffered.
+  @return PROTOMATTER_OK on success, else a ProtomatterStatus from
+          _PM_init() or _PM_begin() (or PROTOMATTER_ERR_MALLOC if the
+          matrix couldn't be attached).
+*/
+extern ProtomatterStatus _PM_hostBegin(Protomatter_core *core, uint16_t width,
+                                       uint8_t depth, uint8_t chains,
+                                       uint8_t addrLines, bool doubleBuffer);
+
+/*!
+  @brief  As _PM_hostBegin(), but with the clock on a given pin. Just
+          above the RGB pins (6 * chains) puts RGB data and clock in one
+          byte for one chain, or one 16-bit word for two, so the core
+          stores 8- or 16-bit elements instead of 32.
+  @param  core          Pointer to Protomatter_core structure.
+  @param  width         Matrix chain width in pixels.
+  @param  depth         Bitplanes (1-6).
+  @param  chains        Parallel matrix chains, RGB pins below clockPin.
+  @param  addrLines     Address lines (row pairs = 2^addrLines).
+  @param  doubleBuffer  If true, double-buffered.
+  @param  clockPin      Clock pin, on the first PORT.
+  @return As _PM_hostBegin().
+*/
+extern ProtomatterStatus _PM_hostBeginClock(Protomatter_core *core,
+                                            uint16_t width, uint8_t depth,
+                                            uint8_t chains, uint8_t addrLines,
+                                            bool doubleBuffer,
+                                            uint8_t clockPin);
+
+/*!
+  @brief  First half of _PM_hostBeginClock(): just _PM_init() on the
+          suggested pins, for settings that go between that and
+          _PM_begin() (e.g. _PM_setPixelDoubling()). Follow with
+          _PM_hostStart().
+  @param  core          Pointer to Protomatter_core structure.
+  @param  width         Matrix chain width in pixels.
+  @param  depth         Bitplanes (1-6).
+  @param  chains        Parallel matrix chains, RGB pins below clockPin.
+  @param  addrLines     Address lines (row pairs = 2^addrLines).
+  @param  doubleBuffer  If true, double-buffered.
+  @param  clockPin      Clock pin, on the first PORT.
+  @return A ProtomatterStatus from _PM_init().
+*/
+extern ProtomatterStatus _PM_hostInit(Protomatter_core *core, uint16_t width,
+                                      uint8_t depth, uint8_t chains,
+                                      uint8_t addrLines, bool doubleBuffer,
+                                      uint8_t clockPin);
+
+/*!
+  @brief  Second half of _PM_hostBeginClock(): start a core following
+          _PM_hostInit() and attach the emulated matrix to it. A core
+          that won't start is freed.
+  @param  core  Pointer to Protomatter_core structure.
+  @return As _PM_hostBegin().
+*/
+extern ProtomatterStatus _PM_hostStart(Protomatter_core *core);
+
+/*!
+  @brief  Start or stop recording matrix output into _PM_hostMatrix: one
+          _PM_hostSpan for each stretch of time a row pair was lit with
+          the same data.
+  @param  enable  true to start, false to stop (ending the span in
+                  progress).
+*/
+extern void _PM_hostRecord(bool enable);
+
+/*!
+  @brief  Discard recorded matrix output. If recording, it carries on
+          from now.
+*/
+extern void _PM_hostClear(void);
+
+/*!
+  @brief  Get which LEDs of one pixel a recorded span lit.
+  @param  span  Pointer to span in _PM_hostMatrix.spans.
+  @param  x     Pixel column.
+  @param  y     Pixel row. The RGB pins of each chain are R1, G1, B1
+                (upper half of the matrix), R2, G2, B2 (lower half),
+                chains stacked top to bottom.
+  @return Bit 0 red, bit 1 green, bit 2 blue; 0 if the span is another
+          row pair's.
+*/
+extern uint8_t _PM_hostLit(const _PM_hostSpan *span, uint16_t x,
+                           uint16_t y);
+
+/*!
+  @brief  Get the perceived (time-averaged) image from recorded output:
+          each LED's on time as a fraction of the time its row pair was
+          lit at all, so 1.0 is as bright as that LED gets.
+  @param  image  Array of width * height * 3 doubles (R, G, B for each
+                 pixel, row-major) to be filled in.
+*/
+extern void _PM_hostImage(double *image);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _PROTOMATTER_HOST_H_
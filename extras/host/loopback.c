@@ -0,0 +1,236 @@
+/*!
+ * @file loopback.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Loopback test of the video wall path (see slicer.h): a controller
+ * slices a series of wall frames for four boards of differing size, depth,
+ * chains, element size and pin map, and sends the payloads in chunks over
+ * sockets to a process per board. Each board loads the chunks with
+ * _PM_loadPayload(), shows the frame, runs refresh on the emulated matrix
+ * (see host.h) and checks the perceived image against its part of the
+ * wall at its bit depth. Exit status is 0 if every board saw every frame.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "slicer.h"
+#include <math.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define WALL_WIDTH 96  ///< Wall frame width in pixels
+#define WALL_HEIGHT 96 ///< Wall frame height in pixels
+#define FRAMES 3       ///< Frames sent
+#define CHUNK 1000     ///< Payload bytes per chunk
+#define REFRESHES 100  ///< Refreshes the board image is averaged over
+
+// A 64x32 board over the top left, two 32x16 boards stacked beside it
+// (one double-buffered with its RGB bits scrambled, and long elements),
+// and two 96x32 chains along the bottom. The first 32x16 board's pins are
+// in the upper half of a 32-bit PORT, or of a 16-bit one.
+static const _PM_sliceBoard boards[] = {
+    {0, 0, 64, 6, 1, 4, 1, {2, 3, 4, 5, 6, 7}, false},
+#if defined(_PM_HOST_SET_CLEAR_COMBINED)
+    {64, 0, 32, 4, 1, 3, 15, {9, 10, 11, 12, 13, 14}, false},
+#else
+    {64, 0, 32, 4, 1, 3, 22, {16, 17, 18, 19, 20, 21}, false},
+#endif
+    {64, 16, 32, 5, 1, 3, 14, {13, 8, 12, 9, 11, 10}, true},
+    {0, 32, 96, 3, 2, 4, 12, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, false},
+};
+#define NUM_BOARDS (sizeof boards / sizeof boards[0])
+
+static const bool doubleBuffer[NUM_BOARDS] = {false, false, true, false};
+
+// Same frames on both ends, from a fixed seed: mostly random pixels, with
+// a row of full white and a row of black to catch stuck bits.
+static void make_frame(uint16_t *wall, uint32_t frame) {
+  uint32_t seed = 12345 + frame * 7919;
+  for (uint32_t i = 0; i < WALL_WIDTH * WALL_HEIGHT; i++) {
+    seed = seed * 1664525 + 1013904223;
+    wall[i] = seed >> 16;
+  }
+  for (uint16_t x = 0; x < WALL_WIDTH; x++) {
+    wall[(frame * 5) % WALL_HEIGHT * WALL_WIDTH + x] = 0xFFFF;
+    wall[(frame * 5 + 1) % WALL_HEIGHT * WALL_WIDTH + x] = 0;
+  }
+}
+
+// Level (0 to 2^depth-1) a 565 color component is shown at, following the
+// bit order of the converters in arch.h (6-bit red and blue reuse the MSB).
+static uint8_t level(uint16_t color, uint8_t c, uint8_t depth) {
+  uint8_t r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+  if (depth == 6) {
+    return (c == 0) ? (r << 1) | (r >> 4) : (c == 1) ? g : (b << 1) | (b >> 4);
+  }
+  return (c == 0) ? r >> (5 - depth) : (c == 1) ? g >> (6 - depth)
+                                                : b >> (5 - depth);
+}
+
+// Record REFRESHES frames of refresh and compare the perceived image to
+// the wall. The recording's ends needn't fall exactly on frame
+// boundaries, so each LED's level is checked to the nearest step rather
+// than exactly.
+static int check(Protomatter_core *core, const _PM_sliceBoard *board,
+                 const uint16_t *wall, uint16_t height, double *image) {
+  // Let one whole refresh go by first: the matrix is still showing the
+  // old data's last row for a while after the first vblank
+  (void)_PM_getFrameCount(core);
+  for (uint32_t frames = 0; frames < 2;) {
+    _PM_hostInterrupt(core);
+    frames += _PM_getFrameCount(core);
+  }
+  _PM_hostRecord(true);
+  for (uint32_t frames = 0; frames < REFRESHES;) {
+    _PM_hostInterrupt(core);
+    frames += _PM_getFrameCount(core);
+  }
+  _PM_hostRecord(false);
+  _PM_hostImage(image);
+  _PM_hostClear();
+
+  uint8_t max = (1 << board->depth) - 1;
+  int errors = 0;
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < board->width; x++) {
+      int32_t wx = board->x + x, wy = board->y + y;
+      uint16_t color = ((wx < WALL_WIDTH) && (wy < WALL_HEIGHT))
+                           ? wall[wy * WALL_WIDTH + wx]
+                           : 0;
+      for (uint8_t c = 0; c < 3; c++) {
+        double shown = image[(y * board->width + x) * 3 + c] * max;
+        if (lround(shown) != level(color, c, board->depth)) {
+          if (!errors++) {
+            fprintf(stderr, "board at %d,%d: pixel %u,%u LED %u shown %.2f, "
+                            "expected %u\n",
+                    board->x, board->y, x, y, c, shown,
+                    level(color, c, board->depth));
+          }
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+// One board: receive, show and check each frame. Returns exit status.
+static int board_main(int fd, const _PM_sliceBoard *board, bool dbuf) {
+  Protomatter_core core;
+  uint8_t addrPins[5];
+  for (uint8_t i = 0; i < 5; i++) {
+    addrPins[i] = _PM_HOST_ADDR + _PM_HOST_ADDR_STEP * i;
+  }
+  _PM_hostReset();
+  // Data shifts in instantly and there's no settle time, so plane times
+  // are exactly as the core schedules them, down to its shortest plane 0
+  static const _PM_panelProfile instant = {0, 0};
+  _PM_hostCosts.writeNs = 0;
+  _PM_hostCosts.entryNs = 0;
+  ProtomatterStatus status = _PM_init(
+      &core, board->width, board->depth, board->chains,
+      (uint8_t *)board->rgbBits, board->addrLines, addrPins, board->clockBit,
+      _PM_HOST_LATCH, _PM_HOST_OE, dbuf, NULL);
+  if (status == PROTOMATTER_OK) {
+    _PM_setLongElements(&core, board->longElements);
+    status = _PM_begin(&core);
+  }
+  if ((status != PROTOMATTER_OK) || !_PM_hostAttach(&core)) {
+    fprintf(stderr, "board at %d,%d: begin failed (%d)\n", board->x,
+            board->y, status);
+    return 1;
+  }
+  _PM_setPanelProfile(&core, &instant);
+
+  uint16_t height = (2 << board->addrLines) * board->chains;
+  uint16_t *wall = malloc(WALL_WIDTH * WALL_HEIGHT * sizeof(uint16_t));
+  double *image = malloc(board->width * height * 3 * sizeof(double));
+  int errors = (!wall || !image);
+  for (uint32_t frame = 0; !errors && (frame < FRAMES); frame++) {
+    uint32_t received;
+    int result;
+    while (!(result = _PM_sliceReceive(fd, &core, &received)))
+      ;
+    if ((result < 0) || (received != frame)) {
+      fprintf(stderr, "board at %d,%d: frame %u not received\n", board->x,
+              board->y, frame);
+      errors = 1;
+      break;
+    }
+    _PM_swapbuffer_maybe(&core);
+    make_frame(wall, frame);
+    errors = check(&core, board, wall, height, image);
+  }
+  free(wall);
+  free(image);
+  _PM_free(&core);
+  return errors ? 1 : 0;
+}
+
+int main(void) {
+  int fds[NUM_BOARDS];
+  pid_t pids[NUM_BOARDS];
+  _PM_slicer slicers[NUM_BOARDS];
+  int err = 0;
+
+  for (uint8_t b = 0; b < NUM_BOARDS; b++) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair)) {
+      perror("socketpair");
+      return 1;
+    }
+    fflush(stdout);
+    if (!(pids[b] = fork())) {
+      close(pair[0]);
+      for (uint8_t i = 0; i < b; i++) {
+        close(fds[i]);
+      }
+      _exit(board_main(pair[1], &boards[b], doubleBuffer[b]));
+    }
+    close(pair[1]);
+    fds[b] = pair[0];
+    if (pids[b] < 0) {
+      perror("fork");
+      return 1;
+    }
+  }
+
+  for (uint8_t b = 0; b < NUM_BOARDS; b++) {
+    ProtomatterStatus status = _PM_sliceBegin(&slicers[b], &boards[b]);
+    if (status != PROTOMATTER_OK) {
+      fprintf(stderr, "slicer %u: begin failed (%d)\n", b, status);
+      return 1;
+    }
+  }
+  uint16_t wall[WALL_WIDTH * WALL_HEIGHT];
+  for (uint32_t frame = 0; !err && (frame < FRAMES); frame++) {
+    make_frame(wall, frame);
+    for (uint8_t b = 0; b < NUM_BOARDS; b++) {
+      uint32_t size;
+      const void *payload = _PM_sliceEncode(&slicers[b], wall, WALL_WIDTH,
+                                            WALL_HEIGHT, &size);
+      if (_PM_sliceSend(fds[b], frame, payload, size, CHUNK)) {
+        fprintf(stderr, "board %u: send failed\n", b);
+        err = 1;
+        break;
+      }
+    }
+  }
+
+  for (uint8_t b = 0; b < NUM_BOARDS; b++) {
+    int status;
+    close(fds[b]);
+    waitpid(pids[b], &status, 0);
+    bool ok = WIFEXITED(status) && !WEXITSTATUS(status);
+    printf("board %u (%ux%u, depth %u, %u chain%s): %s\n", b,
+           boards[b].width, (2 << boards[b].addrLines) * boards[b].chains,
+           boards[b].depth, boards[b].chains,
+           (boards[b].chains > 1) ? "s" : "", ok ? "PASS" : "FAIL");
+    err |= !ok;
+    _PM_sliceEnd(&slicers[b]);
+  }
+  return err;
+}
@@ -0,0 +1,700 @@
+/*!
+ * @file simtest.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Refresh engine tests in virtual time (see host.h). Each simulates a
+ * second or so of refresh, in milliseconds and identically every run:
+ *
+ * - Refresh rate: frame counter against row scans seen by the matrix and
+ *   the rate the measured plane periods add up to.
+ * - Plane timing: _PM_getPlaneTiming() ratios and errors.
+ * - Swaps: double-buffered frames change only on refresh boundaries.
+ * - Pacing: _PM_setFrameRate() swap rate, with no dropped frames.
+ * - Determinism: two runs record exactly the same matrix output.
+ * - Chains: each parallel chain shows its own part of the image, with
+ *   8-, 16- and 32-bit matrix elements.
+ * - Vblank: _PM_waitVblank() returns once a frame, and at once when
+ *   refresh is paused or stopped.
+ * - Cost: _PM_getRowCost() finds the emulated interrupt entry time, with
+ *   or without interrupt coalescing.
+ * - Edits: scrolling, rect, XOR, palette, region, progressive and row-
+ *   hashed updates leave the matrix buffer exactly as a fresh full
+ *   conversion would, as do flat-color runs, with 8-, 16- and 32-bit
+ *   elements, double buffering and pixel doubling.
+ * - Deferred shift: data shifted outside the row handler shows the same
+ *   image, at each element size.
+ *
+ * Exit status is the number of failed checks.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "host.h"
+#include <math.h>
+#include <stdio.h>
+
+#define WIDTH 64                 ///< Matrix width for all tests
+#define ADDR_LINES 4             ///< 32 rows
+#define HEIGHT (2 << ADDR_LINES) ///< Matrix height
+#define SECOND 1000000000ull     ///< Virtual time, ns
+#define SETTLE 100000000ull      ///< Plane timing settles in 100 ms
+#define CHAINS 3                 ///< Most parallel chains tested
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                       \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      failures++;                                                              \
+      printf("  FAIL %s:%d: ", __func__, __LINE__);                            \
+      printf(__VA_ARGS__);                                                     \
+      printf("\n");                                                            \
+    }                                                                          \
+  } while (0) ///< Count and report a failed check
+
+static uint16_t canvas[WIDTH * HEIGHT * CHAINS];
+
+// Next value of a fixed pseudorandom sequence.
+static uint16_t rnd(uint32_t *seed) {
+  *seed = *seed * 1664525 + 1013904223;
+  return *seed >> 16;
+}
+
+// Fill canvas with a fixed pseudorandom image, or one solid color.
+static void fill(uint32_t seed, bool solid, uint16_t color) {
+  for (uint32_t i = 0; i < WIDTH * HEIGHT * CHAINS; i++) {
+    uint16_t r = rnd(&seed);
+    canvas[i] = solid ? color : r;
+  }
+}
+
+static bool start(Protomatter_core *core, uint8_t depth, bool dbuf) {
+  _PM_hostReset();
+  ProtomatterStatus status =
+      _PM_hostBegin(core, WIDTH, depth, 1, ADDR_LINES, dbuf);
+  CHECK(status == PROTOMATTER_OK, "begin failed (%d)", status);
+  return status == PROTOMATTER_OK;
+}
+
+static void test_refresh(void) {
+  Protomatter_core core;
+  if (!start(&core, 6, false)) {
+    return;
+  }
+  fill(1, false, 0);
+  _PM_convert_565(&core, canvas, WIDTH);
+  _PM_hostRun(&core, SETTLE);
+  (void)_PM_getFrameCount(&core);
+  _PM_hostRecord(true);
+  _PM_hostRun(&core, SECOND);
+  _PM_hostRecord(false);
+  uint32_t frames = _PM_getFrameCount(&core);
+
+  // Each scan of the matrix wraps the address lines back to row 0
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint32_t scans = 0;
+  for (uint32_t i = 1; i < log->numSpans; i++) {
+    scans += log->spans[i].row < log->spans[i - 1].row;
+  }
+  CHECK((scans + 1 >= frames) && (scans <= frames + 1),
+        "%u frames counted, %u scans", frames, scans);
+
+  // Measured plane periods add up to the refresh period, plus the settle
+  // time after each address line change and a little for latching
+  _PM_planeTiming timing[6];
+  uint8_t planes = _PM_getPlaneTiming(&core, timing);
+  uint64_t rowTicks = 0;
+  for (uint8_t p = 0; p < planes; p++) {
+    rowTicks += timing[p].ticks;
+  }
+  uint32_t changes = 0;
+  for (uint32_t r = 0; r < log->rowPairs; r++) {
+    changes += __builtin_popcount(r ^ ((r + 1) % log->rowPairs));
+  }
+  uint64_t settleTicks =
+      (uint64_t)changes * core.rowDelay * (_PM_HOST_TIMER_FREQ / 1000000);
+  double hz = (double)_PM_HOST_TIMER_FREQ /
+              (rowTicks * log->rowPairs + settleTicks);
+  CHECK((frames <= hz) && (frames >= hz * 0.95),
+        "%u frames/s, plane periods give %.1f", frames, hz);
+  printf("  %u Hz refresh, %u spans\n", frames, log->numSpans);
+  _PM_free(&core);
+}
+
+static void test_planes(void) {
+  for (uint8_t depth = 1; depth <= 6; depth++) {
+    Protomatter_core core;
+    if (!start(&core, depth, false)) {
+      return;
+    }
+    fill(2, false, 0);
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_hostRun(&core, SECOND);
+    _PM_planeTiming timing[6];
+    uint8_t planes = _PM_getPlaneTiming(&core, timing);
+    CHECK(planes == depth, "depth %u: %u planes", depth, planes);
+    for (uint8_t p = 0; p < planes; p++) {
+      const _PM_planeTiming *t = &timing[p];
+      // Within 5% of target; ratios within 2% (of 8.8 fixed point)
+      CHECK((t->error > -50) && (t->error < 50),
+            "depth %u plane %u: %u ticks vs. %u", depth, p, t->ticks,
+            t->target);
+      CHECK(!p || ((t->ratio * 50 >= t->idealRatio * 49) &&
+                   (t->ratio * 50 <= t->idealRatio * 51)),
+            "depth %u plane %u: ratio %u, ideal %u", depth, p, t->ratio,
+            t->idealRatio);
+    }
+    _PM_free(&core);
+  }
+}
+
+// Each swapped-in frame alternates all white and all black. Everything
+// the matrix shows from the swap to the next refresh boundary must be
+// from that frame, never a mix, except the old refresh's last row pair
+// still lit while the new one's first is shifted out.
+static void test_swaps(void) {
+  Protomatter_core core;
+  if (!start(&core, 6, true)) {
+    return;
+  }
+  _PM_hostRun(&core, SETTLE);
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint32_t torn = 0;
+  for (uint32_t frame = 0; frame < 20; frame++) {
+    uint8_t expect = (frame & 1) ? 7 : 0;
+    fill(0, true, expect ? 0xFFFF : 0);
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_swapbuffer_maybe(&core);
+    (void)_PM_getFrameCount(&core);
+    _PM_hostRecord(true);
+    while (!_PM_getFrameCount(&core)) {
+      _PM_hostInterrupt(&core);
+    }
+    _PM_hostRecord(false);
+    uint32_t i = 0;
+    while ((i < log->numSpans) && (log->spans[i].row == log->rowPairs - 1)) {
+      i++;
+    }
+    CHECK(i < log->numSpans, "frame %u: nothing shown", frame);
+    for (; i < log->numSpans; i++) {
+      const _PM_hostSpan *span = &log->spans[i];
+      for (uint16_t x = 0; x < WIDTH; x++) {
+        torn += _PM_hostLit(span, x, span->row) != expect;
+      }
+    }
+    _PM_hostClear();
+  }
+  CHECK(!torn, "%u columns of spans from the wrong frame", torn);
+  _PM_free(&core);
+}
+
+static void test_pacing(void) {
+  Protomatter_core core;
+  if (!start(&core, 6, true)) {
+    return;
+  }
+  fill(3, false, 0);
+  _PM_hostRun(&core, SETTLE);
+  _PM_setFrameRate(&core, 30);
+  // First swap after setup counts the idle refreshes before it
+  _PM_convert_565(&core, canvas, WIDTH);
+  _PM_swapbuffer_maybe(&core);
+  _PM_getFrameStats(&core, NULL, NULL);
+  (void)_PM_getFrameCount(&core);
+
+  uint64_t end = _PM_hostNow() + SECOND;
+  uint32_t swaps = 0;
+  while (_PM_hostNow() < end) {
+    canvas[swaps % (WIDTH * HEIGHT)] ^= 0xFFFF;
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_swapbuffer_maybe(&core);
+    swaps++;
+  }
+  uint32_t refreshes = _PM_getFrameCount(&core);
+  uint32_t dropped, duplicated;
+  _PM_getFrameStats(&core, &dropped, &duplicated);
+  uint32_t expect = refreshes / core.swapInterval;
+  CHECK((swaps + 1 >= expect) && (swaps <= expect + 1),
+        "%u swaps in %u refreshes at interval %u", swaps, refreshes,
+        core.swapInterval);
+  CHECK((swaps >= 25) && (swaps <= 35), "%u swaps/s, target 30", swaps);
+  CHECK(!dropped && !duplicated, "%u dropped, %u duplicated", dropped,
+        duplicated);
+  printf("  %u swaps/s at %u refreshes each\n", swaps, core.swapInterval);
+  _PM_free(&core);
+}
+
+// FNV-1a over recorded spans and the data they show.
+static uint32_t record_hash(uint32_t *frames) {
+  Protomatter_core core;
+  if (!start(&core, 5, true)) {
+    return 0;
+  }
+  fill(4, false, 0);
+  _PM_setFrameRate(&core, 60);
+  _PM_hostRecord(true);
+  uint64_t end = _PM_hostNow() + SECOND;
+  for (uint32_t i = 0; _PM_hostNow() < end; i++) {
+    canvas[(i * 7919) % (WIDTH * HEIGHT)] = i;
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_swapbuffer_maybe(&core);
+  }
+  _PM_hostRecord(false);
+  *frames = _PM_getFrameCount(&core);
+
+  const _PM_hostLog *log = &_PM_hostMatrix;
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < log->numSpans; i++) {
+    const _PM_hostSpan *span = &log->spans[i];
+    uint64_t words[3] = {span->start, span->end, span->row};
+    const uint8_t *bytes = (const uint8_t *)words;
+    for (uint8_t b = 0; b < sizeof words; b++) {
+      hash = (hash ^ bytes[b]) * 16777619u;
+    }
+    for (uint16_t x = 0; x < log->width; x++) {
+      hash = (hash ^ log->bits[span->bits + x]) * 16777619u;
+    }
+  }
+  hash ^= log->numSpans;
+  _PM_free(&core);
+  return hash;
+}
+
+static void test_determinism(void) {
+  uint32_t frames[2];
+  uint32_t hash0 = record_hash(&frames[0]);
+  uint32_t hash1 = record_hash(&frames[1]);
+  CHECK((hash0 == hash1) && (frames[0] == frames[1]),
+        "runs differ: %08x (%u frames) vs. %08x (%u frames)", hash0,
+        frames[0], hash1, frames[1]);
+}
+
+// Brightness level (0 to 2^depth - 1) that component c (0, 1, 2 for R,
+// G, B) of a 565 color should show at.
+static uint8_t level(uint16_t color, uint8_t c, uint8_t depth) {
+  uint8_t v = (c == 0) ? color >> 11 : (c == 1) ? (color >> 5) & 0x3F
+                                                : color & 0x1F;
+  if (c != 1) {
+    v = (v << 1) | (v >> 4); // 5-bit red and blue expand to 6 bits
+  }
+  return v >> (6 - depth);
+}
+
+// Record a while of refresh (already settled) and count the LEDs of the
+// canvas, all chains, not shown at their level.
+static uint32_t wrong_levels(Protomatter_core *core, uint8_t chains,
+                             uint8_t depth) {
+  static double image[WIDTH * HEIGHT * CHAINS * 3];
+  uint8_t max = (1 << depth) - 1;
+  _PM_hostRecord(true);
+  _PM_hostRun(core, SETTLE);
+  _PM_hostRecord(false);
+  _PM_hostImage(image);
+  uint32_t n = WIDTH * HEIGHT * chains * 3, wrong = 0;
+  for (uint32_t j = 0; j < n; j++) {
+    wrong += lround(image[j] * max) != level(canvas[j / 3], j % 3, depth);
+  }
+  return wrong;
+}
+
+// Each chain's part of a random image must come out on that chain's
+// matrix, level by level. The clock pin's place decides the element size:
+// just above one chain's RGB pins it's 8 bits, two chains' 16, else 32.
+static void test_chains(void) {
+  static const struct {
+    uint8_t chains;
+    uint8_t clock;
+  } configs[] = {{1, 6}, {2, 12}, {2, _PM_HOST_CLOCK}, {3, _PM_HOST_CLOCK}};
+  const uint8_t depth = 3;
+  for (uint8_t i = 0; i < sizeof configs / sizeof configs[0]; i++) {
+    uint8_t chains = configs[i].chains;
+    if (chains * 6 > configs[i].clock) {
+      continue; // Doesn't fit a 16-bit PORT
+    }
+    Protomatter_core core;
+    _PM_hostReset();
+    ProtomatterStatus status = _PM_hostBeginClock(
+        &core, WIDTH, depth, chains, ADDR_LINES, false, configs[i].clock);
+    CHECK(status == PROTOMATTER_OK, "%u chains: begin failed (%d)", chains,
+          status);
+    if (status != PROTOMATTER_OK) {
+      continue;
+    }
+    fill(3, false, 0);
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_hostRun(&core, SETTLE);
+    uint32_t wrong = wrong_levels(&core, chains, depth);
+    CHECK(!wrong, "%u chains, %u-byte elements: %u levels wrong", chains,
+          core.bytesPerElement, wrong);
+    _PM_free(&core);
+  }
+}
+
+static void test_vblank(void) {
+  Protomatter_core core;
+  if (!start(&core, 4, false)) {
+    return;
+  }
+  fill(4, false, 0);
+  _PM_convert_565(&core, canvas, WIDTH);
+  _PM_waitVblank(&core);
+  (void)_PM_getFrameCount(&core);
+  for (uint8_t i = 0; i < 10; i++) {
+    _PM_waitVblank(&core);
+  }
+  uint32_t frames = _PM_getFrameCount(&core);
+  CHECK(frames == 10, "10 waits, %u frames", frames);
+
+  // No frame will come, so these mustn't wait (or hang)
+  _PM_pause(&core);
+  uint64_t t = _PM_hostNow();
+  _PM_waitVblank(&core);
+  CHECK(_PM_hostNow() == t, "waited while paused");
+  _PM_unpause(&core);
+  _PM_stop(&core);
+  t = _PM_hostNow();
+  _PM_waitVblank(&core);
+  CHECK(_PM_hostNow() == t, "waited while stopped");
+  _PM_resume(&core);
+  _PM_waitVblank(&core);
+  CHECK(_PM_getFrameCount(&core) == 1, "no frame after resume");
+  _PM_free(&core);
+}
+
+static void test_cost(void) {
+  _PM_hostCost costs = _PM_hostCosts;
+  _PM_hostCosts.entryNs = 2000;
+  uint32_t entry = _PM_hostCosts.entryNs / (1000000000 / _PM_HOST_TIMER_FREQ);
+  for (uint8_t coalesce = 0; coalesce < 2; coalesce++) {
+    Protomatter_core core;
+    if (!start(&core, 6, false)) {
+      break;
+    }
+    _PM_setCoalescing(&core, coalesce);
+    fill(5, false, 0);
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_hostRun(&core, SETTLE);
+    _PM_rowCost cost;
+    CHECK(_PM_getRowCost(&core, &cost), "no row cost");
+    CHECK((cost.entryTicks + 2 >= entry) && (cost.entryTicks <= entry + 2),
+          "coalescing %u: entry %u ticks, emulated %u", coalesce,
+          cost.entryTicks, entry);
+    CHECK(cost.shiftTicks, "coalescing %u: no shift time", coalesce);
+    _PM_free(&core);
+  }
+  _PM_hostCosts = costs;
+}
+
+// EDITS -------------------------------------------------------------------
+
+// The image edits should have made, and a scratch copy
+static uint16_t expect[WIDTH * HEIGHT * CHAINS];
+static uint16_t scratch[WIDTH * HEIGHT * CHAINS];
+
+// Clip a rectangle to the canvas, as the core does. False if none left.
+static bool clip(uint16_t width, uint16_t height, int16_t *x, int16_t *y,
+                 int16_t *w, int16_t *h) {
+  if (*x < 0) {
+    *w += *x;
+    *x = 0;
+  }
+  if (*y < 0) {
+    *h += *y;
+    *y = 0;
+  }
+  if (*x + *w > width) {
+    *w = width - *x;
+  }
+  if (*y + *h > height) {
+    *h = height - *y;
+  }
+  return (*w > 0) && (*h > 0);
+}
+
+// Random colors in a rectangle of the expected image.
+static void paint(uint16_t width, uint16_t height, int16_t x, int16_t y,
+                  int16_t w, int16_t h, uint32_t *seed) {
+  if (clip(width, height, &x, &y, &w, &h)) {
+    for (int16_t yy = y; yy < y + h; yy++) {
+      for (int16_t xx = x; xx < x + w; xx++) {
+        expect[yy * width + xx] = rnd(seed);
+      }
+    }
+  }
+}
+
+// What _PM_scroll() should do to the expected image.
+static void scroll(uint16_t width, uint16_t height, int16_t x, int16_t y,
+                   int16_t w, int16_t h, int16_t dx, int16_t dy) {
+  if (!clip(width, height, &x, &y, &w, &h)) {
+    return;
+  }
+  memcpy(scratch, expect, width * height * sizeof(uint16_t));
+  for (int16_t yy = y; yy < y + h; yy++) {
+    for (int16_t xx = x; xx < x + w; xx++) {
+      int16_t xs = xx - dx, ys = yy - dy;
+      bool inside = (xs >= x) && (xs < x + w) && (ys >= y) && (ys < y + h);
+      expect[yy * width + xx] = inside ? scratch[ys * width + xs] : 0;
+    }
+  }
+}
+
+// The matrix buffer as edited (after any swap) must be exactly what a
+// full conversion of the expected image gives, element for element,
+// whatever the encoding. That conversion (row hashing off, so every row
+// is converted) is then left in place for the next edit.
+static void check_edit(Protomatter_core *core, uint16_t width,
+                       const char *what, const char *step) {
+  uint8_t *buf = (uint8_t *)_PM_editBuffer(core);
+  uint8_t *edited = (uint8_t *)malloc(core->bufferSize);
+  CHECK(edited, "%s: %s: out of memory", what, step);
+  if (edited) {
+    memcpy(edited, buf, core->bufferSize);
+    _PM_setRowHashing(core, false);
+    _PM_convert_565(core, expect, width);
+    _PM_setRowHashing(core, true);
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < core->bufferSize; i++) {
+      wrong += edited[i] != buf[i];
+    }
+    CHECK(!wrong, "%s: %s: %u of %u bytes differ", what, step, wrong,
+          core->bufferSize);
+    free(edited);
+  }
+}
+
+// Each kind of edit in turn, on a core showing a width x height image
+// (smaller than the matrix if pixels are doubled).
+static void edit_checks(Protomatter_core *core, uint16_t width,
+                        uint16_t height, const char *what) {
+  uint32_t seed = 6, n = width * height;
+  paint(width, height, 0, 0, width, height, &seed);
+  _PM_convert_565(core, expect, width);
+  _PM_swapbuffer_maybe(core);
+
+  // Whole plane lines sideways (both ways, and all the way out), some
+  // lines whole and others not, part of a line, then moves between rows
+  // (and so between RGB pins), clipped at every edge.
+  int16_t w = width, h = height;
+  const int16_t moves[][6] = {
+      {0, 0, w, h, -1, 0},    {0, 4, w, h - 4, 5, 0}, {3, 0, w - 10, h, -7, 0},
+      {0, 0, w, h, w + 6, 0}, {5, 3, 20, 10, 3, -2},  {0, 2, w, 12, 0, 5},
+      {2, 1, w, h, 7, 3},     {-4, -4, w + 8, h + 8, -9, -6}};
+  for (uint8_t m = 0; m < sizeof moves / sizeof moves[0]; m++) {
+    const int16_t *mv = moves[m];
+    paint(width, height, 0, 0, width, height, &seed);
+    _PM_convert_565(core, expect, width);
+    scroll(width, height, mv[0], mv[1], mv[2], mv[3], mv[4], mv[5]);
+    _PM_scroll(core, mv[0], mv[1], mv[2], mv[3], mv[4], mv[5]);
+    _PM_swapbuffer_maybe(core);
+    char step[16];
+    snprintf(step, sizeof step, "scroll %u", m);
+    check_edit(core, width, what, step);
+  }
+
+  paint(width, height, 5, 3, 21, 9, &seed);
+  _PM_convert_565_rect(core, expect, width, 5, 3, 21, 9);
+  paint(width, height, -3, h - 5, 12, 9, &seed);
+  _PM_convert_565_rect(core, expect, width, -3, h - 5, 12, 9);
+  _PM_swapbuffer_maybe(core);
+  check_edit(core, width, what, "rect");
+
+  // Some pixels changed more than once, some off the matrix (skipped)
+  _PM_pixel pixels[100];
+  for (uint8_t i = 0; i < 100; i++) {
+    _PM_pixel *p = &pixels[i];
+    p->x = (int16_t)(rnd(&seed) % (width + 4)) - 2;
+    p->y = (int16_t)(rnd(&seed) % (height + 4)) - 2;
+    p->color = rnd(&seed);
+    if ((p->x >= 0) && (p->x < w) && (p->y >= 0) && (p->y < h)) {
+      uint16_t *e = &expect[p->y * width + p->x];
+      p->color ^= *e; // Delta from what's there
+      *e ^= p->color;
+    }
+  }
+  _PM_convert_565_xor(core, pixels, 100);
+  _PM_swapbuffer_maybe(core);
+  check_edit(core, width, what, "xor");
+
+  // Line segments hanging off either side, rows off the matrix, and
+  // indices past the palette's end (transparent)
+  uint16_t palette[12];
+  uint8_t indices[WIDTH + 8];
+  for (uint8_t i = 0; i < 12; i++) {
+    palette[i] = rnd(&seed);
+  }
+  CHECK(_PM_paletteBegin(core, palette, 12) == PROTOMATTER_OK,
+        "%s: paletteBegin failed", what);
+  for (int16_t y = -1; y <= h; y += 3) {
+    int16_t x = (y % 5) - 2;
+    uint16_t len = width + 2 - (y % 7);
+    for (uint16_t j = 0; j < len; j++) {
+      indices[j] = rnd(&seed) % 16;
+      if ((indices[j] < 12) && (x + j >= 0) && (x + j < w) && (y >= 0) &&
+          (y < h)) {
+        expect[y * width + x + j] = palette[indices[j]];
+      }
+    }
+    _PM_paletteLine(core, x, y, indices, len);
+  }
+  _PM_paletteEnd(core);
+  _PM_swapbuffer_maybe(core);
+  check_edit(core, width, what, "palette");
+
+  // Two regions (one clipped), converted and swapped in together
+  int8_t a = _PM_regionAdd(core, 2, 2, 20, 9);
+  int8_t b = _PM_regionAdd(core, w - 25, h - 6, 30, 20);
+  paint(width, height, 2, 2, 20, 9, &seed);
+  paint(width, height, w - 25, h - 6, 30, 20, &seed);
+  _PM_regionCommit(core, a);
+  _PM_regionCommit(core, b);
+  uint8_t shown = _PM_regionShow(core, expect, width);
+  CHECK(shown == 2, "%s: %u regions shown", what, shown);
+  check_edit(core, width, what, "regions");
+  _PM_regionClear(core);
+
+  // Top planes first, then the rest a plane at a time
+  paint(width, height, 0, 0, width, height, &seed);
+  _PM_convert_565_coarse(core, expect, width, 2);
+  _PM_swapbuffer_maybe(core);
+  uint8_t left;
+  do {
+    left = _PM_convert_565_refine(core, expect, width, 1);
+    _PM_swapbuffer_maybe(core);
+  } while (left);
+  check_edit(core, width, what, "coarse/refine");
+
+  // A few rows change; the rest are skipped as unchanged
+  _PM_convert_565(core, expect, width);
+  _PM_swapbuffer_maybe(core);
+  for (uint8_t i = 0; i < 3; i++) {
+    paint(width, height, 0, (i * 7 + 1) % h, width, 1, &seed);
+  }
+  _PM_convert_565(core, expect, width);
+  _PM_swapbuffer_maybe(core);
+  check_edit(core, width, what, "row hashing");
+
+  // Flat-color runs, taken by the full conversion's fast path, against
+  // the rect converter, which has none
+  uint16_t color = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    if (!(rnd(&seed) % 9)) {
+      color = rnd(&seed);
+    }
+    expect[i] = color;
+  }
+  _PM_convert_565_rect(core, expect, width, 0, 0, width, height);
+  _PM_swapbuffer_maybe(core);
+  check_edit(core, width, what, "runs");
+}
+
+// Clock placement sets element size (see test_chains()); one core is
+// double-buffered, so edits go to a back buffer that's a frame behind,
+// and one shows each pixel as 2x2 LEDs.
+static void test_edits(void) {
+  static const struct {
+    uint8_t chains;
+    uint8_t clock;
+    uint8_t depth;
+    bool dbuf;
+    bool doubled;
+  } configs[] = {{1, 6, 6, false, false},
+                 {2, 12, 5, false, false},
+                 {1, _PM_HOST_CLOCK, 4, true, false},
+                 {1, 6, 4, false, true}};
+  for (uint8_t i = 0; i < sizeof configs / sizeof configs[0]; i++) {
+    Protomatter_core core;
+    _PM_hostReset();
+    ProtomatterStatus status =
+        _PM_hostInit(&core, WIDTH, configs[i].depth, configs[i].chains,
+                     ADDR_LINES, configs[i].dbuf, configs[i].clock);
+    if ((status == PROTOMATTER_OK) && configs[i].doubled) {
+      CHECK(_PM_setPixelDoubling(&core, true, true), "doubling failed");
+    }
+    if (status == PROTOMATTER_OK) {
+      status = _PM_hostStart(&core);
+    }
+    CHECK(status == PROTOMATTER_OK, "config %u: begin failed (%d)", i,
+          status);
+    if (status != PROTOMATTER_OK) {
+      continue;
+    }
+    uint16_t width = WIDTH >> configs[i].doubled;
+    uint16_t height = (HEIGHT * configs[i].chains) >> configs[i].doubled;
+    char what[48];
+    snprintf(what, sizeof what, "%u-byte elements%s%s",
+             core.bytesPerElement, configs[i].dbuf ? ", double-buffered" : "",
+             configs[i].doubled ? ", doubled" : "");
+    edit_checks(&core, width, height, what);
+    _PM_free(&core);
+  }
+}
+
+static bool shiftSignalled = false;
+
+static void shift_signal(void) { shiftSignalled = true; }
+
+// With shifting deferred (_PM_setDeferredShift()), the row handler only
+// signals; the shift is done here straight after, as a lower-priority
+// interrupt would be.
+static void test_deferred(void) {
+  static const uint8_t configs[][2] = {{1, 6}, {2, 12}, {1, _PM_HOST_CLOCK}};
+  const uint8_t depth = 4;
+  for (uint8_t i = 0; i < sizeof configs / sizeof configs[0]; i++) {
+    Protomatter_core core;
+    uint8_t chains = configs[i][0];
+    _PM_hostReset();
+    ProtomatterStatus status = _PM_hostBeginClock(
+        &core, WIDTH, depth, chains, ADDR_LINES, false, configs[i][1]);
+    CHECK(status == PROTOMATTER_OK, "config %u: begin failed (%d)", i,
+          status);
+    if (status != PROTOMATTER_OK) {
+      continue;
+    }
+    _PM_setDeferredShift(&core, shift_signal);
+    fill(8, false, 0);
+    _PM_convert_565(&core, canvas, WIDTH);
+    _PM_hostRecord(true);
+    for (uint64_t end = _PM_hostNow() + SETTLE; _PM_hostNow() < end;) {
+      if (!_PM_hostInterrupt(&core)) {
+        break;
+      }
+      if (shiftSignalled) {
+        shiftSignalled = false;
+        _PM_row_shift(&core);
+      }
+    }
+    _PM_hostRecord(false);
+    uint32_t late = _PM_getLateShifts(&core);
+    CHECK(!late, "%u-byte elements: %u late shifts", core.bytesPerElement,
+          late);
+    uint32_t wrong = wrong_levels(&core, chains, depth);
+    CHECK(!wrong, "%u-byte elements: %u levels wrong", core.bytesPerElement,
+          wrong);
+    _PM_setDeferredShift(&core, NULL);
+    _PM_free(&core);
+  }
+}
+
+int main(void) {
+  static const struct {
+    const char *name;
+    void (*func)(void);
+  } tests[] = {
+      {"refresh", test_refresh}, {"planes", test_planes},
+      {"swaps", test_swaps},     {"pacing", test_pacing},
+      {"determinism", test_determinism}, {"chains", test_chains},
+      {"vblank", test_vblank},           {"cost", test_cost},
+      {"edits", test_edits},             {"deferred", test_deferred},
+  };
+  for (uint8_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+    int before = failures;
+    printf("%s\n", tests[i].name);
+    tests[i].func();
+    printf("  %s\n", (failures == before) ? "PASS" : "FAIL");
+  }
+  _PM_hostReset();
+  return failures;
+}
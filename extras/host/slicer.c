@@ -0,0 +1,147 @@
+/*!
+ * @file slicer.c
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Video wall payload slicing, encoding and transport, see slicer.h.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#include "slicer.h"
+#include <errno.h>
+#include <unistd.h>
+
+// Each board gets a core of its own, set up as the board's would be but
+// with RGB data and clock on emulated PORT 0 at the board's bit positions
+// (which is all the encoding depends on), and its own timer so it never
+// competes with a refreshing core. Refresh is stopped straight away; only
+// the conversion functions are used.
+ProtomatterStatus _PM_sliceBegin(_PM_slicer *slicer,
+                                 const _PM_sliceBoard *board) {
+  uint8_t addrPins[5];
+  for (uint8_t i = 0; i < 5; i++) {
+    addrPins[i] = _PM_HOST_ADDR + _PM_HOST_ADDR_STEP * i;
+  }
+  memset(slicer, 0, sizeof(_PM_slicer));
+  slicer->board = *board;
+  slicer->height = (2 << board->addrLines) * board->chains;
+  slicer->canvas =
+      (uint16_t *)calloc(board->width * slicer->height, sizeof(uint16_t));
+  if (!slicer->canvas) {
+    return PROTOMATTER_ERR_MALLOC;
+  }
+  Protomatter_core *core = &slicer->core;
+  ProtomatterStatus status = _PM_init(
+      core, board->width, board->depth, board->chains,
+      slicer->board.rgbBits, board->addrLines, addrPins, board->clockBit,
+      _PM_HOST_LATCH, _PM_HOST_OE, false, &slicer->timer);
+  if (status == PROTOMATTER_OK) {
+    _PM_setLongElements(core, board->longElements);
+    status = _PM_begin(core);
+  }
+  if (status != PROTOMATTER_OK) {
+    _PM_sliceEnd(slicer);
+    return status;
+  }
+  _PM_stop(core);
+  return PROTOMATTER_OK;
+}
+
+const void *_PM_sliceEncode(_PM_slicer *slicer, const uint16_t *wall,
+                            uint16_t width, uint16_t height, uint32_t *size) {
+  const _PM_sliceBoard *board = &slicer->board;
+  for (uint16_t y = 0; y < slicer->height; y++) {
+    uint16_t *dest = &slicer->canvas[y * board->width];
+    int32_t wy = board->y + y;
+    for (uint16_t x = 0; x < board->width; x++) {
+      int32_t wx = board->x + x;
+      dest[x] = ((wx >= 0) && (wy >= 0) && (wx < width) && (wy < height))
+                    ? wall[wy * width + wx]
+                    : 0;
+    }
+  }
+  _PM_convert_565(&slicer->core, slicer->canvas, board->width);
+  *size = _PM_payloadSize(&slicer->core);
+  return slicer->core.screenData;
+}
+
+void _PM_sliceEnd(_PM_slicer *slicer) {
+  _PM_free(&slicer->core);
+  free(slicer->canvas);
+  slicer->canvas = NULL;
+}
+
+// Write or read all of a buffer, riding out short transfers.
+static int write_all(int fd, const void *data, uint32_t length) {
+  const uint8_t *ptr = (const uint8_t *)data;
+  while (length) {
+    ssize_t n = write(fd, ptr, length);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    ptr += n;
+    length -= n;
+  }
+  return 0;
+}
+
+static int read_all(int fd, void *data, uint32_t length) {
+  uint8_t *ptr = (uint8_t *)data;
+  while (length) {
+    ssize_t n = read(fd, ptr, length);
+    if (n <= 0) {
+      if ((n < 0) && (errno == EINTR)) {
+        continue;
+      }
+      return -1; // Error or end of stream
+    }
+    ptr += n;
+    length -= n;
+  }
+  return 0;
+}
+
+int _PM_sliceSend(int fd, uint32_t frame, const void *payload, uint32_t size,
+                  uint32_t chunk) {
+  if (!chunk || (chunk > size)) {
+    chunk = size;
+  }
+  for (uint32_t offset = 0; offset < size; offset += chunk) {
+    _PM_sliceChunk head = {_PM_SLICE_MAGIC, frame, offset, chunk, size};
+    if (offset + chunk > size) {
+      head.length = size - offset;
+    }
+    if (write_all(fd, &head, sizeof head) ||
+        write_all(fd, (const uint8_t *)payload + offset, head.length)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// Chunks go straight into the matrix buffer, as a board would load them
+// from its network stack's receive buffer.
+int _PM_sliceReceive(int fd, Protomatter_core *core, uint32_t *frame) {
+  _PM_sliceChunk head;
+  if (read_all(fd, &head, sizeof head) || (head.magic != _PM_SLICE_MAGIC) ||
+      (head.total != _PM_payloadSize(core)) || (head.length > head.total)) {
+    return -1;
+  }
+  uint8_t *data = (uint8_t *)malloc(head.length ? head.length : 1);
+  int result = -1;
+  if (data && !read_all(fd, data, head.length) &&
+      (_PM_loadPayload(core, data, head.offset, head.length) ==
+       PROTOMATTER_OK)) {
+    result = (head.offset + head.length == head.total);
+  }
+  free(data);
+  if (frame) {
+    *frame = head.frame;
+  }
+  return result;
+}
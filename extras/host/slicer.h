@@ -0,0 +1,126 @@
+/*!
+ * @file slicer.h
+ *
+ * Part of Adafruit's Protomatter library for HUB75-style RGB LED matrices.
+ *
+ * Video wall controller side of pre-encoded payloads (see _PM_loadPayload()
+ * in core.h): slices one large frame by board layout and encodes each
+ * board's portion for its geometry and pin map, using the core's own
+ * converters on the host build (see host.h), so boards only copy and swap.
+ * Payloads can be sent in chunks over any byte stream (socket, pipe, file)
+ * with _PM_sliceSend(), and loaded on the receiving end with
+ * _PM_sliceReceive() (POSIX hosts) or the same framing on a board.
+ *
+ * Encoding depends on how the board's device drives its PORT: build with
+ * -D_PM_HOST_NO_TOGGLE for devices without a toggle register (e.g. nRF52,
+ * ESP32), -D_PM_HOST_SET_CLEAR_COMBINED for 16-bit PORTs with combined
+ * set/clear registers (STM32; board pins are then PORT bits 0-15), and
+ * -D_PM_chunkSize to match its loop unroll (see arch.h).
+ *
+ * BSD license, all text here must be included in any redistribution.
+ *
+ */
+
+#ifndef _PROTOMATTER_SLICER_H_
+#define _PROTOMATTER_SLICER_H_
+
+#include "host.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One board of a video wall: where it sits and how it's wired. */
+typedef struct {
+  int16_t x;           ///< Left edge within the wall frame, in pixels
+  int16_t y;           ///< Top edge within the wall frame, in pixels
+  uint16_t width;      ///< Matrix chain width in pixels
+  uint8_t depth;       ///< Bitplanes (1-6)
+  uint8_t chains;      ///< Parallel matrix chains (1-5)
+  uint8_t addrLines;   ///< Address lines (height = 2^addrLines * 2 * chains)
+  uint8_t clockBit;    ///< PORT bit (0-31, 0-15 if 16-bit) of clock pin
+  uint8_t rgbBits[30]; ///< PORT bits of its RGB pins, R1 G1 B1 R2 G2 B2...
+  bool longElements;   ///< If 1, board uses _PM_setLongElements()
+} _PM_sliceBoard;
+
+/** Encoder state for one board, see _PM_sliceBegin(). */
+typedef struct {
+  _PM_sliceBoard board; ///< Board layout, copied
+  Protomatter_core core; ///< Core used for encoding only (never refreshed)
+  _PM_hostTimer timer;   ///< Timer for that core, not the shared one
+  uint16_t *canvas;      ///< Board-sized 565 canvas, sliced from the wall
+  uint16_t height;       ///< Board height in pixels
+} _PM_slicer;
+
+/** Header preceding each chunk of payload data in a byte stream. */
+typedef struct {
+  uint32_t magic;  ///< _PM_SLICE_MAGIC
+  uint32_t frame;  ///< Frame number, from the sender
+  uint32_t offset; ///< Byte offset of the data within the payload
+  uint32_t length; ///< Bytes of data following this header
+  uint32_t total;  ///< Payload size; the chunk ending there completes it
+} _PM_sliceChunk;
+
+#define _PM_SLICE_MAGIC 0x314D5050 ///< "PPM1" little-endian, chunk start
+
+/*!
+  @brief  Set up an encoder for one board.
+  @param  slicer  Pointer to _PM_slicer structure.
+  @param  board   Board layout (copied).
+  @return PROTOMATTER_OK on success, else as for _PM_begin().
+*/
+extern ProtomatterStatus _PM_sliceBegin(_PM_slicer *slicer,
+                                        const _PM_sliceBoard *board);
+
+/*!
+  @brief  Encode a board's portion of a wall frame. Pixels of the board
+          outside the frame are black.
+  @param  slicer  Pointer to _PM_slicer structure.
+  @param  wall    Wall frame, 565 colors, row-major.
+  @param  width   Wall frame width in pixels.
+  @param  height  Wall frame height in pixels.
+  @param  size    Receives payload size in bytes (_PM_payloadSize() on a
+                  board configured the same way).
+  @return Pointer to payload, valid until the next call or _PM_sliceEnd().
+*/
+extern const void *_PM_sliceEncode(_PM_slicer *slicer, const uint16_t *wall,
+                                   uint16_t width, uint16_t height,
+                                   uint32_t *size);
+
+/*!
+  @brief  Free an encoder's resources.
+  @param  slicer  Pointer to _PM_slicer structure.
+*/
+extern void _PM_sliceEnd(_PM_slicer *slicer);
+
+/*!
+  @brief  Send a payload over a byte stream as _PM_sliceChunk-headed
+          chunks.
+  @param  fd       File descriptor (socket, pipe, file).
+  @param  frame    Frame number, passed along in each header.
+  @param  payload  Payload from _PM_sliceEncode().
+  @param  size     Payload size in bytes.
+  @param  chunk    Maximum data bytes per chunk (0 = all in one).
+  @return 0 on success, -1 on write error.
+*/
+extern int _PM_sliceSend(int fd, uint32_t frame, const void *payload,
+                         uint32_t size, uint32_t chunk);
+
+/*!
+  @brief  Receive one chunk from a byte stream and load it into a
+          board's matrix buffer with _PM_loadPayload(). Once a payload is
+          complete, the caller shows it (_PM_swapbuffer_maybe()).
+  @param  fd     File descriptor.
+  @param  core   Pointer to the receiving board's Protomatter_core.
+  @param  frame  Receives the chunk's frame number (or NULL).
+  @return 1 if the payload is now complete, 0 if more is to come, -1 on
+          end of stream, read error, or a chunk that doesn't fit.
+*/
+extern int _PM_sliceReceive(int fd, Protomatter_core *core,
+                            uint32_t *frame);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _PROTOMATTER_SLICER_H_